@@ -8,10 +8,17 @@
 #define DLLIST_H
 
 #include <stdbool.h>
+#include "prefetch.h"
+#include "my_malloc.h"
 
-// Using Opaque pointers
+// Using Opaque pointers - but for the items, whose layout is exposed so that
+// walking the list (dllist_next, DLLIST_FOREACH, ...) can be inlined
 
-typedef struct dllitm_ dllitm_t;
+typedef struct dllitm_ {
+  void *data;
+  struct dllitm_ *next;
+  struct dllitm_ *prev;
+} dllitm_t;
 
 typedef struct dllist_ dllist_t;
 
@@ -24,6 +31,16 @@ bool dllist_new(dllist_t **lst,
              void (*destroy)(void *data),
              void (*cb)(const void *data));
 
+/*
+ * same as dllist_new, but the list and its items are allocated with alloc
+ * (see allocator_t in my_malloc.h) - NULL means the default allocator
+ */
+bool dllist_new_with(dllist_t **lst, 
+                     int (*match)(const void *k1, const void *k2), 
+                     void (*destroy)(void *data),
+                     void (*cb)(const void *data),
+                     const allocator_t *alloc);
+
 
 void dllist_free(dllist_t **lst);
 
@@ -79,10 +96,39 @@ dllitm_t *dllist_head(const dllist_t *lst);
 
 dllitm_t *dllist_tail(const dllist_t *lst);
 
-void *dllist_data(const dllitm_t *itm);
+static inline void *dllist_data(const dllitm_t *itm) {
+  return itm->data;
+}
+
+static inline dllitm_t *dllist_next(const dllitm_t *itm) {
+  return itm->next;
+}
+
+static inline dllitm_t *dllist_prev(const dllitm_t *itm) {
+  return itm->prev;
+}
+
+/*
+ * Callback-free iteration (a cursor over the items): the body runs once for
+ * each item itm of lst, a dllitm_t * declared by the macro, from the head to
+ * the tail (DLLIST_FOREACH) or from the tail to the head
+ * (DLLIST_FOREACH_REVERSE):
+ *
+ *   DLLIST_FOREACH(lst, itm) { person_print(dllist_data(itm)); }
+ *
+ * Only the first step calls out (dllist_head/dllist_tail), the rest is
+ * inlined, and the next item is prefetched while the body runs.  The body
+ * must not remove itm from the list.
+ */
 
-dllitm_t *dllist_next(const dllitm_t *itm);
+#define DLLIST_FOREACH(lst, itm)                                    \
+  for (dllitm_t *itm = dllist_head(lst);                            \
+       itm != NULL && (PREFETCH(itm->next), 1);                     \
+       itm = itm->next)
 
-dllitm_t *dllist_prev(const dllitm_t *itm);
+#define DLLIST_FOREACH_REVERSE(lst, itm)                            \
+  for (dllitm_t *itm = dllist_tail(lst);                            \
+       itm != NULL && (PREFETCH(itm->prev), 1);                     \
+       itm = itm->prev)
 
 #endif
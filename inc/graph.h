@@ -11,6 +11,7 @@
 #include <stdbool.h>
 
 #include "sllist.h"
+#include "my_malloc.h"
 
 // adjacency list
 typedef struct AdjList_ {
@@ -30,6 +31,7 @@ typedef struct Graph_ {
   void      (*lcb)(const void *pdata);
   sllist_t  adjlists;
   bool      directed;   // make the graph directed or not, default is true
+  const allocator_t *alloc;   // for the adjacency lists and their items
 } graph_t;
 
 // define state for graph traversal 
@@ -46,6 +48,7 @@ typedef struct {
   void (*cb)(const void *pdata);
   void (*lcb)(const void *pdata);
   bool directed;
+  const allocator_t *alloc;   // optional, e.g. graph_new(&g, match, .alloc = &arena)
 } args_t;
 
 
@@ -60,14 +63,16 @@ int graph_new_base(graph_t **graph,
               void (*destroy)(void *data),
               void (*cb)(const void *pdata),
               void (*lcb)(const void *pdata),
-              bool directed);
+              bool directed,
+              const allocator_t *alloc);
 
 void graph_init_base(graph_t *graph, 
                 int (*match)(const void *key1, const void *key2), 
                 void (*destroy)(void *data),
                 void (*cb)(const void *pdata),
                 void (*lcb)(const void *pdata),
-                bool directed);
+                bool directed,
+                const allocator_t *alloc);
 
 void graph_free(graph_t **graph);
 
@@ -1,6 +1,7 @@
 #ifndef _hashset_
 #define _hashset_
 #include "vector.h"
+#include <stdint.h>
 
 /* File: hashtable.h
  * ------------------
@@ -17,9 +18,29 @@
  * in the hashset_cmp_fun_t sense) is hashed.  Ideally, the
  * hash routine would manage to distribute the spectrum of client elements
  * as uniformly over the [0, numBuckets) range as possible.
+ *
+ * Whatever the engine, the hashset_t calls it exactly once per hashset_enter
+ * or hashset_lookup, with SIZE_MAX for numBuckets, and keeps that full width
+ * hash code next to the element: it reduces the code to a bucket itself,
+ * compares codes before calling the hashset_cmp_fun_t, and never calls the
+ * hash routine again for a stored element, not even to grow or rehash.  A
+ * routine returning some hash value modulo numBuckets works as is.
+ */
+
+typedef size_t (*hashset_hash_fun_t)(const void *elemAddr, size_t numBuckets);
+
+/**
+ * Type: hashset_hash64_fun_t
+ * --------------------------
+ * The other kind of hash function (see hashset_new64): returns a 64-bit hash
+ * code for the element at elemAddr, not reduced to any range.  The hashset_t
+ * then keeps a power of two number of buckets and takes the low bits of the
+ * code, a mask instead of a division, so all the bits of the code should be
+ * well mixed: use the built-in hashers below, or feed the key to
+ * hashset_hash_bytes.
  */
 
-typedef int (*hashset_hash_fun_t)(const void *elemAddr, int numBuckets);
+typedef uint64_t (*hashset_hash64_fun_t)(const void *elemAddr);
 
 /**
  * Type: hashset_cmp_fun_t
@@ -62,6 +83,34 @@ typedef void (*hashset_map_fun_t)(void *elemAddr, void *auxData);
 
 typedef void (*hashset_free_fun_t)(void *elemAddr);
 
+/**
+ * Type: hashset_engine_t
+ * ----------------------
+ * How a hashset_t stores its elements, chosen at construction time (see
+ * hashset_new_engine), behind the same hashset_enter/lookup/map interface:
+ *
+ *   - HASHSET_CHAINED: buckets, each a vector_t searched linearly.  This is
+ *     the engine of hashset_new.
+ *   - HASHSET_ROBIN_HOOD: open addressing.  The elements live inline in one
+ *     flat table of slots and collide by linear probing, with the Robin Hood
+ *     rule: an element being entered takes the slot of a resident element
+ *     which is closer to its own home slot (and the resident moves on), which
+ *     keeps the probe sequences short and even.  A lookup stops as soon as it
+ *     meets an element closer to home than the key would be.  Each slot is a
+ *     bucket.
+ *
+ * With both engines the number of buckets doubles (every entry being moved to
+ * its new bucket from its stored hash code, without calling the hash
+ * function) as soon as the load factor (count / number of buckets) exceeds the maximum
+ * load (see hashset_set_max_load): 1.0 for HASHSET_CHAINED, 0.9 for
+ * HASHSET_ROBIN_HOOD by default.
+ */
+
+typedef enum {
+  HASHSET_CHAINED,
+  HASHSET_ROBIN_HOOD
+} hashset_engine_t;
+
 /**
  * Type: hashset_t
  * -------------
@@ -73,15 +122,32 @@ typedef void (*hashset_free_fun_t)(void *elemAddr);
  */
 
 typedef struct {
-  hashset_hash_fun_t  hash_fun;
+  hashset_hash_fun_t  hash_fun;    // exactly one of hash_fun and hash64_fun is set
+  hashset_hash64_fun_t hash64_fun;
   hashset_cmp_fun_t   cmp_fun;
   hashset_free_fun_t  free_fun;  
   //
-  uint_t   num_buckets;     // num. of buckets in the hashset_t
-  uint_t   count;           // num. of element in a hashset_t
-  usint_t  elem_size;       // size of an element
-  uint_t   chunk_size;      // how many element(s) to store in vector (initially)
-  vector_t *bucket_lst;     // array of num_buckets element
+  size_t   num_buckets;     // num. of buckets in the hashset_t
+  size_t   count;           // num. of element in a hashset_t
+  size_t   elem_size;       // size of an element
+  size_t   entry_size;      // size of an entry: the element, then its hash code
+  size_t   hash_offset;     // offset of the hash code in an entry
+  size_t   chunk_size;      // how many element(s) to store in vector (initially)
+  vector_t *bucket_lst;     // array of num_buckets buckets (vector_t of entries)
+  const allocator_t *alloc; // for the bucket array and the buckets
+  hashset_engine_t engine;
+  // HASHSET_CHAINED only, for incremental rehashes
+  bool     incremental;     // grow by incremental rehashes (hashset_set_incremental)
+  vector_t *old_bucket_lst; // the buckets being moved to bucket_lst, or NULL
+  size_t   old_num_buckets;
+  size_t   rehash_pos;      // the old buckets below it have moved
+  size_t   rehash_step;     // old buckets moved per step, so that none is left at the next growth
+  double   max_load;        // the table grows once count / num_buckets exceeds it
+  size_t   grow_at;         // the count above which it grows
+  // HASHSET_ROBIN_HOOD only (num_buckets is then the number of slots)
+  char     *slots;          // num_buckets entries, inline
+  uint32_t *probe_len;      // per slot: 0 if empty, else 1 + distance to its home slot
+  void     *tmp;            // two entries: the one being entered (carried along while probing), and a swap area
   //
 } hashset_t;
 
@@ -98,9 +164,9 @@ typedef struct {
  * raised if this size is less than or equal to 0.
  *
  * The numBuckets parameter specifies the number of buckets that the elements
- * will be partitioned into.  Once a hashset_t is created, this number does
- * not change.  The numBuckets parameter must be in sync with the behavior of
- * the hashfn, which must return a hash code between 0 and numBuckets - 1.   
+ * will be partitioned into initially.  This number grows as elements are
+ * entered (see hashset_set_max_load), so the hashfn must return a hash code
+ * between 0 and numBuckets - 1 for whatever numBuckets it is passed.
  * The hashfn parameter specifies the function that is called to retrieve the
  * hash code for a given element.  See the type declaration of hashset_hash_fun_t
  * above for more information.  An assert is raised if numBuckets is less than or
@@ -124,9 +190,44 @@ typedef struct {
  *    - cmpfn is non-NULL
  */
 
-void hashset_new(hashset_t *h, int elemSize, int numBuckets, 
+void hashset_new(hashset_t *h, size_t elemSize, size_t numBuckets, 
 		hashset_hash_fun_t hashfn, hashset_cmp_fun_t cmpfn, hashset_free_fun_t freefn);
 
+/**
+ * Function:  hashset_new_with
+ * --------------------------
+ * Same as hashset_new, but all the memory of the hashset_t (its bucket array
+ * and the storage of the buckets) comes from alloc (see allocator_t in
+ * my_malloc.h).  NULL for alloc means the default allocator.
+ */
+
+void hashset_new_with(hashset_t *h, size_t elemSize, size_t numBuckets,
+                      hashset_hash_fun_t hashfn, hashset_cmp_fun_t cmpfn, hashset_free_fun_t freefn,
+                      const allocator_t *alloc);
+
+/**
+ * Function:  hashset_new_engine
+ * ----------------------------
+ * Same as hashset_new_with, with the given storage engine (see
+ * hashset_engine_t above).
+ */
+
+void hashset_new_engine(hashset_t *h, hashset_engine_t engine, size_t elemSize, size_t numBuckets,
+                        hashset_hash_fun_t hashfn, hashset_cmp_fun_t cmpfn, hashset_free_fun_t freefn,
+                        const allocator_t *alloc);
+
+/**
+ * Function:  hashset_new64
+ * ------------------------
+ * Same as hashset_new_engine, with a 64-bit hash function (see
+ * hashset_hash64_fun_t).  The number of buckets is always a power of two:
+ * numBuckets is rounded up to one, and so is the argument of hashset_rehash.
+ */
+
+void hashset_new64(hashset_t *h, hashset_engine_t engine, size_t elemSize, size_t numBuckets,
+                   hashset_hash64_fun_t hashfn, hashset_cmp_fun_t cmpfn, hashset_free_fun_t freefn,
+                   const allocator_t *alloc);
+
 /**
  * Function: hashset_dispose
  * ------------------------
@@ -152,7 +253,66 @@ void hashset_dispose(hashset_t *h);
  * the specified hashset_t.
  */
 
-uint_t hashset_count(const hashset_t *h);
+size_t hashset_count(const hashset_t *h);
+
+/**
+ * Function: hashset_set_max_load
+ * ------------------------------
+ * Sets the maximum load factor, i.e. the average number of elements per
+ * bucket above which the hashset_t doubles its number of buckets; the
+ * hashset_t is rehashed at once if it is already above.  Lower values trade
+ * memory for shorter buckets (or probe sequences).  An assert is raised if
+ * maxLoad is not positive, or not less than 1 for HASHSET_ROBIN_HOOD (whose
+ * buckets hold one element each).
+ */
+
+void hashset_set_max_load(hashset_t *h, double maxLoad);
+
+/**
+ * Function: hashset_reserve
+ * -------------------------
+ * Makes sure the hashset_t can hold at least n elements without growing
+ * again, rehashing it once now if needed.  Use it before entering a known
+ * number of elements, instead of guessing numBuckets up front.
+ */
+
+void hashset_reserve(hashset_t *h, size_t n);
+
+/**
+ * Function: hashset_rehash
+ * ------------------------
+ * Redistributes every element into numBuckets buckets (rounded up to a power
+ * of two for a hashset_new64 table), or into the fewest buckets holding the
+ * current elements within the maximum load factor if numBuckets is less than
+ * that (so it may shrink the hashset_t).  Runs in O(count + buckets); the
+ * entries move from their stored hash codes, the hash function is not
+ * called.  An assert is raised if numBuckets is 0.
+ */
+
+void hashset_rehash(hashset_t *h, size_t numBuckets);
+
+/**
+ * Function: hashset_set_incremental
+ * ---------------------------------
+ * Turns incremental rehashing on or off, for the HASHSET_CHAINED engine only
+ * (an assert is raised otherwise).  When the hashset_t grows, instead of
+ * moving every element into the new buckets at once (a pause proportional to
+ * its size), it keeps both bucket arrays live and every hashset_enter and
+ * hashset_lookup moves a few old buckets, until none is left: the cost of a
+ * rehash is spread over the following calls.  The number of buckets moved
+ * per call is sized so that the old array is empty by the time the
+ * hashset_t grows again, whatever the maximum load factor.  Meanwhile each element is in
+ * exactly one of the two arrays, so a lookup still hashes the key once and
+ * searches a single bucket.  Hence, in this mode, even
+ * hashset_lookup invalidates the addresses returned by previous lookups, and
+ * concurrent lookups are not safe.  Turning it off completes a rehash in
+ * progress; hashset_reserve, hashset_rehash and hashset_set_max_load always
+ * do too.  hashset_rehashing tells whether a rehash is in progress.
+ */
+
+void hashset_set_incremental(hashset_t *h, bool incremental);
+
+bool hashset_rehashing(const hashset_t *h);
 
 /**
  * Function: hashset_enter
@@ -162,9 +322,10 @@ uint_t hashset_count(const hashset_t *h);
  * inserted (SAME POS. as far as the hash and compare functions are 
  * concerned), then the old element is replaced by this new element
  *
- * An assert is raised if the specified address is NULL, or
- * if the embedded hash function somehow computes a hash code
- * for the element that is out of the [0, numBuckets) range.
+ * The hash function is called once on the element (with SIZE_MAX for
+ * numBuckets, see hashset_hash_fun_t); the hashset_t keeps the hash code
+ * with the element and reduces it to a bucket itself, so any code it
+ * returns is valid.  An assert is raised if the specified address is NULL.
  */
 
 void hashset_enter(hashset_t *h, const void *elemAddr);
@@ -180,9 +341,9 @@ void hashset_enter(hashset_t *h, const void *elemAddr);
  * to match a stored element as far as the hash and compare
  * functions are concerned.
  *
- * An assert is raised if the specified address is NULL, or
- * if the embedded hash function somehow computes a hash code
- * for the element that is out of the [0, numBuckets) range.
+ * The key is hashed once, as in hashset_enter, and the compare function is
+ * only called on the stored elements whose cached hash code is the same.
+ * An assert is raised if the specified address is NULL.
  */
 
 void *hashset_lookup(const hashset_t *h, const void *elemAddr);
@@ -203,5 +364,38 @@ void *hashset_lookup(const hashset_t *h, const void *elemAddr);
  */
 
 void hashset_map(hashset_t *h, hashset_map_fun_t mapfn, void *auxData);
+
+/**
+ * Functions: built-in hashers
+ * ---------------------------
+ * Fast 64-bit hash functions, in the manner of wyhash: inputs are consumed 8
+ * bytes at a time and mixed with 64x64->128 bit multiplications, so that any
+ * change of the input changes about half the bits of the code.  The codes
+ * are the same on every run, but depend on the byte order of the machine: do
+ * not store them.
+ *
+ *   hashset_hash_bytes - the len bytes at data, with a seed (0 will do)
+ *   hashset_hash_str   - the NUL-terminated string s, one strlen and one pass
+ *                        (same as hashset_hash_bytes(s, strlen(s), 0))
+ *   hashset_hash_u64   - a 64-bit integer (narrower ones convert to it)
+ *
+ * and, as hashset_hash64_fun_t for hashset_new64:
+ *
+ *   hashset_hash_str_elem - the element is a char *, the string is hashed
+ *   hashset_hash_u32_elem - the element starts with a 32-bit integer key
+ *   hashset_hash_u64_elem - the element starts with a 64-bit integer key
+ */
+
+uint64_t hashset_hash_bytes(const void *data, size_t len, uint64_t seed);
+
+uint64_t hashset_hash_str(const char *s);
+
+uint64_t hashset_hash_u64(uint64_t key);
+
+uint64_t hashset_hash_str_elem(const void *elemAddr);
+
+uint64_t hashset_hash_u32_elem(const void *elemAddr);
+
+uint64_t hashset_hash_u64_elem(const void *elemAddr);
      
 #endif
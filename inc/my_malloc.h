@@ -8,4 +8,46 @@ void *xmalloc(size_t sz);
 
 void *xmalloc0(size_t sz);
 
+/*
+ * Pluggable allocators
+ * --------------------
+ * An allocator_t tells a container (vector_t, hashset_t, sllist_t, dllist_t,
+ * graph_t) where its memory comes from, e.g. an arena or a pool dedicated to
+ * one workload.  Each function gets the ctx pointer of the allocator back as
+ * its first argument, and the size of the block (as it was allocated) when it
+ * is resized or given back, so that simple region or pool allocators do not
+ * have to store it themselves:
+ *
+ *   alloc(ctx, sz)                   - a new block of sz bytes, NULL on failure
+ *   realloc(ctx, ptr, old_sz, new_sz)- resizes the block ptr (keeping its
+ *                                      contents), NULL on failure (ptr is then
+ *                                      still valid)
+ *   free(ctx, ptr, sz)               - gives the block ptr back
+ *
+ * Containers created with a NULL allocator use default_allocator, i.e.
+ * malloc, realloc and free.  An allocator must outlive the containers using it.
+ */
+
+typedef struct allocator_ {
+  void *(*alloc)(void *ctx, size_t sz);
+  void *(*realloc)(void *ctx, void *ptr, size_t old_sz, size_t new_sz);
+  void  (*free)(void *ctx, void *ptr, size_t sz);
+  void  *ctx;
+} allocator_t;
+
+extern const allocator_t default_allocator;
+
+// the allocator to use: alloc, or the default one if alloc is NULL
+#define allocator_or_default(alloc) ((alloc) != NULL ? (alloc) : &default_allocator)
+
+/*
+ * Same as xmalloc and xmalloc0 (exit with an error if the allocation fails),
+ * with the given allocator
+ */
+void *xalloc(const allocator_t *alloc, size_t sz);
+
+void *xalloc0(const allocator_t *alloc, size_t sz);
+
+void xfree(const allocator_t *alloc, void *ptr, size_t sz);
+
 #endif
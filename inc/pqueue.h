@@ -0,0 +1,158 @@
+/**
+ * File: pqueue.h
+ * --------------
+ * Defines the interface for the pqueue_t, a priority queue.
+ *
+ * The pqueue_t is a d-ary heap (d = 2 or 4) laid out in a vector_t: the
+ * element at the top is always the least one according to the client's
+ * comparison function (reverse the comparison to get a max-queue).  Push and
+ * pop run in O(log n), peek in constant time.  With d = 4 the heap is half
+ * as deep and the children of a node are contiguous, so a pop touches fewer
+ * cache lines, at the price of a few more comparisons per level.
+ *
+ * Every pushed element gets a handle, which stays valid while the element is
+ * in the pqueue_t whatever the moves of the heap, so that the priority of an
+ * element can be changed in place (the decrease-key of Dijkstra's shortest
+ * paths or of a scheduler):
+ *
+ *   pqueue_t pq;
+ *   pqueue_new(&pq, sizeof(struct task), task_cmp, NULL, 4);
+ *   pqueue_handle_t h = pqueue_push(&pq, &task);
+ *   ...
+ *   task.deadline = sooner;
+ *   pqueue_decrease_key(&pq, h, &task);
+ *
+ * The handles of the popped elements are recycled by the next pushes.
+ */
+
+#ifndef _pqueue_
+#define _pqueue_
+
+#include "vector.h"
+
+typedef int (*pqueue_cmp_fun_t)(const void *elemAddr1, const void *elemAddr2);
+
+typedef void (*pqueue_free_fun_t)(void *elemAddr);
+
+typedef size_t pqueue_handle_t;
+
+/**
+ * Type: pqueue_t
+ * --------------
+ * The concrete representation of the pqueue_t.  As for vector_t, the client
+ * should only interact with it through the functions below.
+ */
+
+typedef struct pqueue_ {
+  pqueue_cmp_fun_t  cmp_fun;
+  pqueue_free_fun_t free_fun;
+  uint_t    arity;
+  vector_t  heap;           // the elements, in heap order
+  vector_t  handles;        // the handle of the element at each heap position
+  vector_t  slots;          // the heap position of each handle, or the next free handle
+  size_t    free_slot;      // head of the list of free handles
+  void      *tmp;           // one element, for the moves of the heap
+} pqueue_t;
+
+/**
+ * Function: pqueue_new
+ * --------------------
+ * Constructs a raw or previously destroyed pqueue_t to be empty, for elements
+ * of elemSize bytes ordered by cmp_fun.  free_fun (may be NULL) is called on
+ * the elements left in the pqueue_t when it is disposed of, and on the
+ * elements popped without being copied out.  arity is the number of children
+ * of each node of the heap, 2 or 4.  An assert is raised if elemSize is 0,
+ * cmp_fun is NULL or arity is neither 2 nor 4.
+ */
+
+void pqueue_new(pqueue_t *pq, size_t elemSize, pqueue_cmp_fun_t cmp_fun, pqueue_free_fun_t free_fun, uint_t arity);
+
+/**
+ * Function: pqueue_dispose
+ * ------------------------
+ * Frees up all the memory of the pqueue_t, calling free_fun on each element
+ * still in it.
+ */
+
+void pqueue_dispose(pqueue_t *pq);
+
+/**
+ * Function: pqueue_len
+ * --------------------
+ * Returns the number of elements in the pqueue_t.  Runs in constant time.
+ */
+
+size_t pqueue_len(const pqueue_t *pq);
+
+/**
+ * Function: pqueue_push
+ * ---------------------
+ * Copies the element at elemAddr into the pqueue_t and returns its handle.
+ * Runs in O(log n) (amortized, as vector_append).
+ */
+
+pqueue_handle_t pqueue_push(pqueue_t *pq, const void *elemAddr);
+
+/**
+ * Function: pqueue_peek
+ * ---------------------
+ * Returns the address of the least element, or NULL if the pqueue_t is
+ * empty.  The element must not be modified in place (see pqueue_update); the
+ * pointer is invalidated by any other call on the pqueue_t.
+ */
+
+void *pqueue_peek(const pqueue_t *pq);
+
+/**
+ * Function: pqueue_pop
+ * --------------------
+ * Removes the least element, copying it to elemAddr, or passing it to
+ * free_fun if elemAddr is NULL.  Its handle becomes invalid.  Runs in
+ * O(log n).  An assert is raised if the pqueue_t is empty.
+ */
+
+void pqueue_pop(pqueue_t *pq, void *elemAddr);
+
+/**
+ * Function: pqueue_heapify
+ * ------------------------
+ * Pushes all the elements of v (copied as vector_append does, in the order
+ * of v) at once, rebuilding the heap bottom-up: O(n) instead of the
+ * O(n log n) of as many pqueue_push.  On an empty pqueue_t, whatever was
+ * pushed and popped before, the handle of each element is its position in v
+ * (the handles of the popped elements are not reused out of order).  An
+ * assert is raised if the element sizes differ.
+ */
+
+void pqueue_heapify(pqueue_t *pq, const vector_t *v);
+
+/**
+ * Functions: pqueue_contains, pqueue_get
+ * --------------------------------------
+ * pqueue_contains tells whether handle is the handle of an element of the
+ * pqueue_t (i.e. it was returned by a push and the element was not popped
+ * since).  pqueue_get returns the address of that element, with the same
+ * validity as pqueue_peek.  For pqueue_get, an assert is raised if handle is
+ * not in use.
+ */
+
+bool pqueue_contains(const pqueue_t *pq, pqueue_handle_t handle);
+
+void *pqueue_get(const pqueue_t *pq, pqueue_handle_t handle);
+
+/**
+ * Functions: pqueue_decrease_key, pqueue_update
+ * ---------------------------------------------
+ * Overwrite the element of the given handle with the element at elemAddr
+ * (free_fun is not called on the old one), then restore the heap: the handle
+ * stays the same.  pqueue_decrease_key only moves the element towards the
+ * top, an assert is raised if the new element is greater than the old one;
+ * pqueue_update accepts any new element.  Both run in O(log n).  An assert
+ * is raised if handle is not in use.
+ */
+
+void pqueue_decrease_key(pqueue_t *pq, pqueue_handle_t handle, const void *elemAddr);
+
+void pqueue_update(pqueue_t *pq, pqueue_handle_t handle, const void *elemAddr);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+/*
+ * PREFETCH(addr): hints the CPU to start loading the cache line at addr,
+ * e.g. the next node of a linked list while the current one is processed.
+ * A hint only: it never faults, so addr may be NULL.  Expands to nothing
+ * with compilers lacking __builtin_prefetch, or when built with -DNO_PREFETCH.
+ */
+
+#if defined(__GNUC__) && !defined(NO_PREFETCH)
+#define PREFETCH(addr) __builtin_prefetch((addr))
+#else
+#define PREFETCH(addr) ((void) 0)
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * File: segvector.h
+ * ------------------
+ * Defines the interface for the segvector_t, a segmented vector.
+ *
+ * A vector_t keeps its elements in one contiguous block, which has to be
+ * reallocated (moved and copied as a whole) when it grows: any pointer
+ * returned by vector_nth is then invalidated, and huge vectors pay a copy
+ * spike on each growth.  The segvector_t stores its elements in a list of
+ * segments of doubling sizes (B, 2B, 4B, 8B, ... elements where B is a power
+ * of two): growing only allocates a new segment, existing elements never move,
+ * and the address of an element stays valid until the element is removed or
+ * the segvector_t is disposed of.  Indexed access is still constant time: the
+ * segment of an element is found from the position of the highest bit set in
+ * its (shifted) index.
+ *
+ * The price is that the elements are not contiguous as a whole (only within
+ * a segment), so there is no insertion/deletion in the middle, nor sorting.
+ */
+
+#ifndef _segvector_
+#define _segvector_
+
+#include "vector.h"
+#include <limits.h>
+
+// enough segments to address any size_t position
+#define SEGVECTOR_MAX_SEGMENTS (sizeof(size_t) * CHAR_BIT)
+
+/**
+ * Type: segvector_t
+ * ---------------
+ * The concrete representation of the segvector_t.  As for vector_t, the
+ * client should only interact with it through the functions below.
+ */
+
+typedef struct segvector_ {
+  vector_free_fun_t free_fun;
+  //
+  size_t  size;           // how many element(s) are in the segvector
+  size_t  elem_size;      // size of an element
+  uint_t  base_shift;     // the first segment holds (1 << base_shift) elements
+  uint_t  num_segments;   // number of segments currently allocated
+  //
+  void *segments[SEGVECTOR_MAX_SEGMENTS];   // segment k holds (1 << (base_shift + k)) elements
+} segvector_t;
+
+/**
+ * Function: segvector_new
+ * Usage: segvector_t records;
+ *        segvector_new(&records, sizeof(record_t), NULL, 1024);
+ * ----------------------
+ * Constructs a raw or previously destroyed segvector_t to be empty.  The
+ * elemSize and free_fun parameters have the same meaning as for vector_new.
+ * The first segment holds initAlloc elements, rounded up to a power of two
+ * (0 means a default size); each following segment is twice as large as the
+ * previous one.  Segments are allocated lazily.  An assert is raised if
+ * elemSize is 0, or if initAlloc does not round up to a power of two that
+ * fits in a size_t.
+ */
+
+void segvector_new(segvector_t *sv, size_t elemSize, vector_free_fun_t free_fun, size_t initAlloc);
+
+/**
+ * Function: segvector_dispose
+ * ---------------------------
+ * Calls the free_fun (if any) on each element, then frees all the segments.
+ */
+
+void segvector_dispose(segvector_t *sv);
+
+/**
+ * Function: segvector_len
+ * -----------------------
+ * Returns the logical length of the segvector_t.  Runs in constant time.
+ */
+
+size_t segvector_len(const segvector_t *sv);
+
+/**
+ * Function: segvector_nth
+ * -----------------------
+ * Returns a pointer to the element numbered position (from 0).  An assert is
+ * raised if position is not less than the logical length.  Runs in constant
+ * time.  Unlike vector_nth, the returned pointer stays valid across appends:
+ * it is only invalidated when the element itself is removed.
+ */
+
+void *segvector_nth(const segvector_t *sv, size_t position);
+
+/**
+ * Function: segvector_append
+ * --------------------------
+ * Appends a copy of the element at elemAddr to the end of the segvector_t
+ * and returns its address in the segvector_t.  Runs in constant time: when the
+ * last segment is full, a new segment is allocated and nothing is copied.
+ */
+
+void *segvector_append(segvector_t *sv, const void *elemAddr);
+
+/**
+ * Function: segvector_replace
+ * ---------------------------
+ * Overwrites the element at the specified position with a copy of the element
+ * at elemAddr, after calling the free_fun (if any) on the old element.
+ * An assert is raised if position is not less than the logical length.
+ */
+
+void segvector_replace(segvector_t *sv, const void *elemAddr, size_t position);
+
+/**
+ * Function: segvector_pop
+ * -----------------------
+ * Removes the last element, calling the free_fun (if any) on it.  The segment
+ * storage is kept for later appends.  An assert is raised if the segvector_t is
+ * empty.
+ */
+
+void segvector_pop(segvector_t *sv);
+
+/**
+ * Function: segvector_map
+ * -----------------------
+ * Calls map_fun on each element, in order, with the auxData pointer (see
+ * vector_map).  An assert is raised if map_fun is NULL.
+ */
+
+void segvector_map(segvector_t *sv, vector_map_fun_t map_fun, void *auxData);
+
+#endif
@@ -8,6 +8,8 @@
 #define SLLIST_H
 
 #include <stdbool.h>
+#include "prefetch.h"
+#include "my_malloc.h"
 
 
 typedef struct sllitm_ {   // list item 
@@ -24,7 +26,8 @@ typedef struct sllist_ {
   //
   sllistItm_t *head;
   sllistItm_t *tail;
-   
+  //
+  const allocator_t *alloc;      // where the items (and the list itself) come from
 } sllist_t;
 
 
@@ -36,6 +39,16 @@ int list_new(sllist_t **lst,
              void (*destroy)(void *data),
              void (*cb)(const void *data));
 
+/*
+ * same as list_new, but the list and its items are allocated with alloc
+ * (see allocator_t in my_malloc.h) - NULL means the default allocator
+ */
+int list_new_with(sllist_t **lst, 
+                  int (*match)(const void *k1, const void *k2), 
+                  void (*destroy)(void *data),
+                  void (*cb)(const void *data),
+                  const allocator_t *alloc);
+
 /*
  * Already allocated but not yet initialize (which is mainly init: size/head/tail and functions)
  */
@@ -44,7 +57,27 @@ void list_init(sllist_t *lst,
                void (*destroy)(void *data),
                void (*cb)(const void *data));
 
+/*
+ * same as list_init, the items being allocated with alloc (NULL means the
+ * default allocator)
+ */
+void list_init_with(sllist_t *lst, 
+                    int (*match)(const void *k1, const void *k2), 
+                    void (*destroy)(void *data),
+                    void (*cb)(const void *data),
+                    const allocator_t *alloc);
+
+
+/*
+ * remove (and destroy) all the items, the list itself stays valid (and empty)
+ * - that is the way to empty a list set up with list_init
+ */
+void list_clear(sllist_t *lst);
 
+
+/*
+ * list_clear, then free the list itself - only for a list created by list_new
+ */
 void list_free(sllist_t **lst);
 
 
@@ -65,7 +98,9 @@ int list_rem_next(sllist_t *lst, sllistItm_t *itm, void **data);
 
 
 /*
- * remove item pointed to by data (return 0 if success)
+ * remove the first item matching *data (match function), set *data to the
+ * data it held and free the item - the data itself is not destroyed, it
+ * goes back to the caller (return 0 if success, -1 if no item matches)
  * Complexity is O(n)
  */
 int list_rem(sllist_t *lst, void **data);
@@ -103,4 +138,19 @@ void list_iter(const sllist_t *lst);
 
 #define list_next(itm) ((itm)->next)
 
+/*
+ * Callback-free iteration: the body runs once for each item itm of lst, from
+ * the head to the tail, where itm is a sllistItm_t * declared by the macro:
+ *
+ *   LIST_FOREACH(lst, itm) { sum += *(int *) list_data(itm); }
+ *
+ * Everything is inlined (no cb call per item) and the next item is
+ * prefetched while the body runs.  The body must not remove itm from the list.
+ */
+
+#define LIST_FOREACH(lst, itm)                                      \
+  for (sllistItm_t *itm = list_head(lst);                           \
+       itm != NULL && (PREFETCH(itm->next), 1);                     \
+       itm = itm->next)
+
 #endif
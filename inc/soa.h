@@ -0,0 +1,149 @@
+/**
+ * File: soa.h
+ * -----------
+ * Defines the interface for the soa_t, a struct-of-arrays vector.
+ *
+ * A vector_t of records stores whole records one after the other (array of
+ * structs): scanning a single field (summing a column, filtering on a key)
+ * drags every other field of each record through the cache as well.  The soa_t
+ * stores the same records field by field instead: each column (a field of the
+ * record) lives in its own contiguous array, a vector_t of that field's type.
+ * A column scan is then a sequential walk over a plain array, which the
+ * compiler can vectorize:
+ *
+ *   typedef struct { int id; double price; } item_t;
+ *   const soa_column_t kItemColumns[] = { SOA_COLUMN(item_t, id),
+ *                                         SOA_COLUMN(item_t, price) };
+ *   soa_t items;
+ *   soa_new(&items, kItemColumns, 2, sizeof(item_t), 0);
+ *   soa_append(&items, &(item_t) { 42, 9.99 });
+ *   ...
+ *   const double *prices = soa_column(&items, 1);
+ *   for (size_t k = 0; k < soa_len(&items); k++) total += prices[k];
+ *
+ * Records go in and out whole (soa_append scatters a record over the columns,
+ * soa_get_row gathers it back), so the client keeps using its record type.
+ * The fields are copied as raw bytes: there is no free function.
+ */
+
+#ifndef _soa_
+#define _soa_
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * Type: soa_column_t
+ * ------------------
+ * Describes a column: the offset and the size (in bytes) of its field within
+ * a record.  SOA_COLUMN(type, field) builds the descriptor of a field of a
+ * struct type.
+ */
+
+typedef struct {
+  size_t offset;
+  size_t size;
+} soa_column_t;
+
+#define SOA_COLUMN(type, field) { offsetof(type, field), sizeof(((type *) 0)->field) }
+
+/**
+ * Type: soa_t
+ * -----------
+ * The concrete representation of the soa_t.  As for vector_t, the client
+ * should only interact with it through the functions below.
+ */
+
+typedef struct soa_ {
+  size_t       num_columns;
+  size_t       row_size;      // size of a record, as read by soa_append
+  soa_column_t *columns;      // copy of the column descriptors
+  vector_t     *data;         // one vector_t per column, of the field's size
+} soa_t;
+
+/**
+ * Function: soa_new
+ * -----------------
+ * Constructs a raw or previously destroyed soa_t to be empty, with the
+ * numColumns columns described by columns (the array is copied) for records
+ * of rowSize bytes.  initAlloc has the same meaning as for vector_new, for
+ * each column.  An assert is raised if there are no columns, or a column is
+ * empty or does not fit in the record.
+ */
+
+void soa_new(soa_t *s, const soa_column_t *columns, size_t numColumns, size_t rowSize, size_t initAlloc);
+
+/**
+ * Function: soa_dispose
+ * ---------------------
+ * Frees up all the memory of the soa_t.
+ */
+
+void soa_dispose(soa_t *s);
+
+/**
+ * Function: soa_len
+ * -----------------
+ * Returns the number of records in the soa_t.  Runs in constant time.
+ */
+
+size_t soa_len(const soa_t *s);
+
+/**
+ * Function: soa_reserve
+ * ---------------------
+ * Makes sure every column can hold at least n records without any further
+ * reallocation (see vector_reserve).
+ */
+
+void soa_reserve(soa_t *s, size_t n);
+
+/**
+ * Function: soa_append
+ * --------------------
+ * Appends the record at rowAddr (rowSize bytes) to the end of the soa_t: each
+ * of its fields is appended to its column.  Runs in amortized constant time.
+ */
+
+void soa_append(soa_t *s, const void *rowAddr);
+
+/**
+ * Function: soa_get_row
+ * ---------------------
+ * Copies the fields of the record numbered position into the record at
+ * rowAddr (the bytes of rowAddr which belong to no column are left
+ * untouched).  An assert is raised if position is not less than the length.
+ */
+
+void soa_get_row(const soa_t *s, size_t position, void *rowAddr);
+
+/**
+ * Function: soa_set_row
+ * ---------------------
+ * Overwrites the record numbered position with the fields of the record at
+ * rowAddr.  An assert is raised if position is not less than the length.
+ */
+
+void soa_set_row(soa_t *s, size_t position, const void *rowAddr);
+
+/**
+ * Function: soa_column
+ * --------------------
+ * Returns the address of the contiguous array holding the column numbered
+ * column, i.e. soa_len values of the column's field, in record order.  As for
+ * vector_nth, the pointer is invalidated by soa_append and soa_reserve.
+ * An assert is raised if column is not less than the number of columns.
+ */
+
+void *soa_column(const soa_t *s, size_t column);
+
+/**
+ * Function: soa_nth
+ * -----------------
+ * Returns the address of the field of the column numbered column within the
+ * record numbered position.  Same validity as soa_column.
+ */
+
+void *soa_nth(const soa_t *s, size_t column, size_t position);
+
+#endif
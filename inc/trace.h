@@ -0,0 +1,110 @@
+/**
+ * File: trace.h
+ * -------------
+ * Defines a small tracing facility for the ADT libraries.
+ *
+ * Diagnostics are emitted with the TRACE_ERROR, TRACE_WARN, TRACE_INFO and
+ * TRACE_DEBUG macros, which take printf-like arguments:
+ *
+ *   TRACE_DEBUG("insert at position: %zu // logical size: %zu", pos, v->size);
+ *
+ * Each macro is kept only if its level is <= TRACE_LEVEL, a compile-time
+ * setting; the others expand to ((void) 0), so that their arguments are not
+ * even evaluated.  TRACE_LEVEL defaults to TRACE_LVL_NONE: a release build
+ * carries no trace code at all.  Compile with e.g. -DTRACE_LEVEL=4 (DEBUG
+ * builds of the makefiles do) to get everything down to TRACE_DEBUG.
+ *
+ * The traces that are compiled in go to stderr by default (see trace_output).
+ * They can be recorded instead in an in-memory ring buffer holding the last
+ * TRACE_RING_SIZE messages, which is dumped after the fact with trace_dump,
+ * e.g. from a debugger or a signal handler.  The facility is not thread-safe.
+ */
+
+#ifndef _trace_
+#define _trace_
+
+#include <stdio.h>
+
+#define TRACE_LVL_NONE  0
+#define TRACE_LVL_ERROR 1
+#define TRACE_LVL_WARN  2
+#define TRACE_LVL_INFO  3
+#define TRACE_LVL_DEBUG 4
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LVL_NONE
+#endif
+
+// number of messages kept by the ring buffer, and max length of each of them
+#define TRACE_RING_SIZE 256
+#define TRACE_MSG_MAX   128
+
+/**
+ * Function: trace_emit
+ * --------------------
+ * Formats and emits one trace message; level is one of the TRACE_LVL_*
+ * constants, file, line and func locate the call site.  Not meant to be called
+ * directly: use the TRACE_* macros below.
+ */
+
+void trace_emit(int level, const char *file, int line, const char *func,
+                const char *fmt, ...)
+#if defined(__GNUC__)
+  __attribute__((format(printf, 5, 6)))
+#endif
+  ;
+
+/**
+ * Function: trace_output
+ * ----------------------
+ * Redirects the traces to the stream fp, or stops printing them if fp is
+ * NULL.  Default is stderr.  Independent of the ring buffer.
+ */
+
+void trace_output(FILE *fp);
+
+/**
+ * Function: trace_ring_enable
+ * ---------------------------
+ * Starts (enable != 0) or stops (enable == 0) recording the traces in the ring
+ * buffer.  Starting the recording discards the messages recorded so far.
+ */
+
+void trace_ring_enable(int enable);
+
+/**
+ * Function: trace_dump
+ * --------------------
+ * Writes the messages held by the ring buffer, oldest first, to the stream fp.
+ * Returns the number of messages written.
+ */
+
+int trace_dump(FILE *fp);
+
+#define TRACE_AT_(lvl, ...) trace_emit(lvl, __FILE__, __LINE__, __func__, __VA_ARGS__)
+
+#if TRACE_LEVEL >= TRACE_LVL_ERROR
+#define TRACE_ERROR(...) TRACE_AT_(TRACE_LVL_ERROR, __VA_ARGS__)
+#else
+#define TRACE_ERROR(...) ((void) 0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_LVL_WARN
+#define TRACE_WARN(...)  TRACE_AT_(TRACE_LVL_WARN, __VA_ARGS__)
+#else
+#define TRACE_WARN(...)  ((void) 0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_LVL_INFO
+#define TRACE_INFO(...)  TRACE_AT_(TRACE_LVL_INFO, __VA_ARGS__)
+#else
+#define TRACE_INFO(...)  ((void) 0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_LVL_DEBUG
+#define TRACE_DEBUG(...) TRACE_AT_(TRACE_LVL_DEBUG, __VA_ARGS__)
+#else
+#define TRACE_DEBUG(...) ((void) 0)
+#endif
+
+#endif
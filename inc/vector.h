@@ -17,6 +17,10 @@
 #define _vector_
 
 #include "bool.h"
+#include "my_malloc.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
 
 typedef unsigned int uint_t;
 typedef unsigned short int usint_t;
@@ -49,6 +53,55 @@ typedef int (*vector_cmp_fun_t)(const void *elemAddr1, const void *elemAddr2);
 
 typedef void (*vector_map_fun_t)(void *elemAddr, void *auxData);
 
+/**
+ * Type: vector_pred_fun_t
+ * ---------------------------
+ * vector_pred_fun_t defines the space of predicates used to select elements
+ * of a vector_t (see vector_remove_if).  A predicate is called with a pointer
+ * to the element and a client data pointer passed in from the original caller,
+ * and returns true if the element is selected.
+ */
+
+typedef bool (*vector_pred_fun_t)(const void *elemAddr, void *auxData);
+
+/**
+ * Type: vector_key_fun_t
+ * ---------------------------
+ * vector_key_fun_t defines the space of functions that extract an unsigned
+ * integer sort key from an element (see vector_radix_sort).  Elements must be
+ * ordered as their keys are; e.g. for signed integers, flip the sign bit
+ * (key = (uint64_t) n ^ (1ULL << 63)) so that negative numbers come first.
+ */
+
+typedef uint64_t (*vector_key_fun_t)(const void *elemAddr);
+
+/**
+ * Type: vector_extract_fun_t
+ * ---------------------------
+ * vector_extract_fun_t defines the space of functions that compute the sort
+ * key of an element (see vector_sort_by_key): it is called with the address
+ * of an element and writes its key (a fixed number of bytes) at keyAddr.
+ */
+
+typedef void (*vector_extract_fun_t)(const void *elemAddr, void *keyAddr);
+
+/**
+ * Types: vector_reduce_fun_t, vector_combine_fun_t
+ * ------------------------------------------------
+ * vector_reduce_fun_t defines the space of functions used to fold the elements
+ * of a vector_t into an accumulator (see vector_reduce): it is called with the
+ * address of the accumulator, the address of an element and a client data
+ * pointer, and updates the accumulator in place.
+ *
+ * vector_combine_fun_t defines the space of functions used to merge two
+ * partial accumulators (see vector_reduce_parallel): it folds the accumulator
+ * at otherAccAddr into the one at accAddr.
+ */
+
+typedef void (*vector_reduce_fun_t)(void *accAddr, const void *elemAddr, void *auxData);
+
+typedef void (*vector_combine_fun_t)(void *accAddr, const void *otherAccAddr, void *auxData);
+
 /**
  * Type: vector_free_fun_t
  * ---------------------------------
@@ -60,6 +113,24 @@ typedef void (*vector_map_fun_t)(void *elemAddr, void *auxData);
 
 typedef void (*vector_free_fun_t)(void *elemAddr);
 
+/**
+ * Constant: VECTOR_INLINE_BYTES
+ * -----------------------------
+ * Size in bytes of the small buffer embedded in each vector_t.  As long as its
+ * elements fit in there, a vector_t does not allocate anything on the heap: it
+ * only spills to the heap when it grows beyond it.  This saves a malloc (and a
+ * pointer chase) per vector for the many tiny vectors of a hashset_t.  It can be
+ * tuned at compile time (-DVECTOR_INLINE_BYTES=...), and must be positive.
+ */
+
+#ifndef VECTOR_INLINE_BYTES
+#define VECTOR_INLINE_BYTES 32
+#endif
+
+#if VECTOR_INLINE_BYTES <= 0
+#error "VECTOR_INLINE_BYTES must be positive"
+#endif
+
 /**
  * Type: vector_t
  * ------------
@@ -69,19 +140,67 @@ typedef void (*vector_free_fun_t)(void *elemAddr);
  * the privacy of the representation and initialize,
  * dispose of, and otherwise interact with a
  * vector_t using those functions defined in this file.
+ *
+ * Lengths, positions and the element size are size_t, so a vector_t can hold
+ * as many elements, as large, as the address space allows.  Every size
+ * computation on the growth paths is checked: a request that would not fit in
+ * a size_t fails as an allocation failure does (the program exits), it never
+ * wraps around.
+ *
+ * While the elements live in the small buffer, headptr is NULL (rather than
+ * pointing into the struct itself), so that a vector_t can still be copied
+ * around by value, e.g. as part of an element stored in another container.
  */
 
 typedef struct vector_ {
   vector_free_fun_t free_fun;
+  const allocator_t *alloc;  // where the heap chunk comes from
   //
-  uint_t size;          // how many item/element are in the current vector
-  uint_t chunk_size;    // size of chunk to allocate/de-allocate  - example 4 units
-  usint_t chunk_num;    // number of chunk(s) currently allocated - example 1 at the beginning
-  usint_t elem_size;    // size of an element                     - example size of a fraction, if we store fractions  
+  size_t size;          // how many item/element are in the current vector
+  size_t chunk_size;    // initial allocation and minimal growth step - example 4 units
+  size_t capacity;      // number of element slots currently allocated
+  size_t elem_size;     // size of an element                     - example size of a fraction, if we store fractions  
+  uint_t flags;         // storage flags (e.g. headptr points into a file mapping)
   //
-  void *headptr;        // pointer to first chunk of data
+  void *headptr;        // pointer to first chunk of data, NULL while in inline_buf
+  union {               // small buffer - the union aligns it for any element type
+    unsigned char bytes[VECTOR_INLINE_BYTES];
+    long double   ld_align;
+    long long     ll_align;
+    void          *ptr_align;
+  } inline_buf;
 } vector_t;
 
+/**
+ * Function: vector_data
+ * ---------------------
+ * Returns the address of the first element of the contiguous storage of
+ * the vector_t (either its small buffer or its heap chunk).  Like the
+ * pointers returned by vector_nth, it is invalidated by any operation
+ * that may reallocate the storage.
+ */
+
+static inline void *vector_data(const vector_t *v) {
+  return (v->headptr != NULL) ? v->headptr : (void *) v->inline_buf.bytes;
+}
+
+/**
+ * Macro: VECTOR_FOREACH
+ * Usage: VECTOR_FOREACH(&numbers, long, p) { sum += *p; }
+ * ---------------------
+ * Callback-free alternative to vector_map: runs the body once for each
+ * element of the vector_t, in order, with p (a T *, declared by the macro)
+ * pointing to the element.  T must be the type of the elements (an assert
+ * checks that sizeof(T) is the elem_size).  Being a plain loop over the
+ * contiguous storage, the compiler can inline, unroll and vectorize it.  The
+ * body must not insert nor delete elements (it may update *p in place).
+ */
+
+#define VECTOR_FOREACH(v, T, p)                                                \
+  for (T *p = (assert(sizeof(T) == (v)->elem_size), (T *) vector_data(v)),     \
+         *p##_end_ = p + vector_len(v);                                        \
+       p < p##_end_; p++)
+
 /**
  * Function: vector_new
  * Usage: vector_t myFriends;
@@ -103,36 +222,42 @@ typedef struct vector_ {
  * NULL for the free_fun if the elements don't require any special handling.
  *
  * The initAlloc parameter specifies the initial allocated length 
- * of the vector_t, as well as the dynamic reallocation increment for those times when the 
- * vector_t needs to grow.  Rather than growing the vector_t one element at a time as 
- * elements are added (inefficient), you will grow the vector_t 
- * in chunks of initAlloc size.  The allocated length is the number
- * of elements for which space has been allocated: the logical length 
- * is the number of those slots currently being used.
+ * of the vector_t, as well as the minimal reallocation increment for those times when 
+ * the vector_t needs to grow.  The allocated length is the number of elements for
+ * which space has been allocated: the logical length is the number of those slots
+ * currently being used.
  * 
- * A new vector_t pre-allocates space for initAlloc elements, but the
- * logical length is zero.  As elements are added, those allocated slots fill
- * up, and when the initial allocation is all used, grow the vector_t by another 
- * initAlloc elements.  You will continue growing the vector_t in chunks
- * like this as needed.  Thus the allocated length will always be a multiple
- * of initAlloc.  Don't worry about using realloc to shrink the vector_t's 
- * allocation if a bunch of elements get deleted.  It turns out that 
- * many implementations of realloc don't even pay attention to such a request, 
- * so there is little point in asking.  Just leave the vector_t over-allocated and no
- * one will care.
+ * A new vector_t stores its first elements in its small buffer (see
+ * VECTOR_INLINE_BYTES) and allocates space for (at least) initAlloc elements when
+ * it outgrows it; the logical length is zero.  When the allocation is all used,
+ * the vector_t grows geometrically: the allocated length is doubled (and grown by
+ * at least initAlloc elements).  Appending n elements thus costs O(n) copying
+ * overall, i.e. vector_append runs in amortized constant time.  The allocation is
+ * never shrunk behind the client's back when elements get deleted; use
+ * vector_shrink_to_fit to give the slack back explicitly.
  *
  * The initAlloc is the client's opportunity to tune the resizing
- * behavior for his/her particular needs.  Clients who expect their vectors to
- * become large should probably choose a large initial allocation size, whereas
- * clients who expect the vector_t to be relatively small should choose a smaller
- * initAlloc size.  You want to minimize the number of reallocations, but
- * you don't want to pre-allocate all that much memory if you don't expect to use very
- * much of it.  If the client passes 0 for initAlloc, the implementation
- * will use the default value of its own choosing.  As assert is raised is 
- * the initAlloc value is less than 0.
+ * behavior for his/her particular needs.  Clients who know in advance how many
+ * elements they will store should rather call vector_reserve once.  If the client
+ * passes 0 for initAlloc, the implementation will use the default value of its
+ * own choosing.
  */
 
-void vector_new(vector_t *v, uint_t elemSize, vector_free_fun_t free_fun, uint_t initAlloc);
+void vector_new(vector_t *v, size_t elemSize, vector_free_fun_t free_fun, size_t initAlloc);
+
+/**
+ * Function: vector_new_with
+ * Usage: vector_new_with(&points, sizeof(point_t), NULL, 0, &arena_allocator);
+ * -------------------------
+ * Same as vector_new, but the heap storage of the vector_t is allocated,
+ * grown and given back with alloc (see allocator_t in my_malloc.h) instead
+ * of malloc, realloc and free.  NULL for alloc means the default allocator,
+ * i.e. vector_new(v, ...) is vector_new_with(v, ..., NULL).  The scratch
+ * buffers of the sort and reduce functions still come from malloc.
+ */
+
+void vector_new_with(vector_t *v, size_t elemSize, vector_free_fun_t free_fun, size_t initAlloc,
+                     const allocator_t *alloc);
 
 /**
  * Function: vector_dispose
@@ -154,8 +279,40 @@ void vector_dispose(vector_t *v);
  * currently in the vector_t.  Must run in constant time.
  */
 
-uint_t vector_len(const vector_t *v);
+size_t vector_len(const vector_t *v);
 	   
+/**
+ * Function: vector_capacity
+ * -------------------------
+ * Returns the allocated length of the vector_t, i.e. the number of elements
+ * it can hold before it needs to reallocate its storage.  Always greater
+ * than or equal to vector_len.  Runs in constant time.
+ */
+
+size_t vector_capacity(const vector_t *v);
+
+/**
+ * Function: vector_reserve
+ * ------------------------
+ * Makes sure the vector_t can hold at least n elements without any further
+ * reallocation.  If n is not greater than the current capacity, nothing
+ * happens.  The logical length is not changed.  Bulk loaders which know their
+ * final size up front should call this once before appending.
+ */
+
+void vector_reserve(vector_t *v, size_t n);
+
+/**
+ * Function: vector_shrink_to_fit
+ * ------------------------------
+ * Reallocates the storage of the vector_t so that its capacity matches its
+ * logical length (moving the elements back into the small buffer, and releasing
+ * the heap storage entirely, when they fit in there).
+ * Pointers previously returned by vector_nth become invalid.
+ */
+
+void vector_shrink_to_fit(vector_t *v);
+
 /**
  * Method: vector_nth
  * -----------------
@@ -172,7 +329,7 @@ uint_t vector_len(const vector_t *v);
  * sorting of the vector_t, as all of these may rearrange the elements to some extent.
  */ 
 
-void *vector_nth(const vector_t *v, uint_t position);
+void *vector_nth(const vector_t *v, size_t position);
 					  
 /**
  * Function: vector_insert
@@ -184,7 +341,7 @@ void *vector_nth(const vector_t *v, uint_t position);
  * the memory pointed to by elemAddr.  This method runs in linear time.
  */
 
-void vector_insert(vector_t *v, const void *elemAddr, uint_t position);
+void vector_insert(vector_t *v, const void *elemAddr, size_t position);
 
 /**
  * Function: vector_append
@@ -193,12 +350,35 @@ void vector_insert(vector_t *v, const void *elemAddr, uint_t position);
  * passed by address, and the element contents are copied from the memory pointed 
  * to by elemAddr.  Note that right after this call, the new element will be 
  * the last in the vector_t; i.e. its element number will be the logical length 
- * minus 1.  This method must run in constant time (neglecting the memory reallocation 
- * time which may be required occasionally).
+ * minus 1.  This method runs in amortized constant time (the storage grows
+ * geometrically, so reallocations get rarer as the vector_t grows).
  */
 
 void vector_append(vector_t *v, const void *elemAddr);
   
+/**
+ * Function: vector_insert_range
+ * -----------------------------
+ * Inserts n new elements into the specified vector_t, placing the first one at
+ * the specified position.  The elements are read from the contiguous block
+ * starting at elemsAddr (n * elemSize bytes), which must not point into the
+ * vector_t's own storage.  The elements after position are shifted over once,
+ * as a whole block, to make room.  An assert is raised if position is greater
+ * than the logical length.  Inserting 0 elements is a no-op.
+ */
+
+void vector_insert_range(vector_t *v, const void *elemsAddr, size_t n, size_t position);
+
+/**
+ * Function: vector_append_n
+ * -------------------------
+ * Appends the n elements of the contiguous block starting at elemsAddr to the
+ * end of the specified vector_t.  Same as vector_insert_range at the logical
+ * length, the storage is grown (at most) once.
+ */
+
+void vector_append_n(vector_t *v, const void *elemsAddr, size_t n);
+
 /**
  * Function: vector_replace
  * -----------------------
@@ -212,7 +392,7 @@ void vector_append(vector_t *v, const void *elemAddr);
  * operate in constant time.
  */
 
-void vector_replace(vector_t *v, const void *elemAddr, uint_t position);
+void vector_replace(vector_t *v, const void *elemAddr, size_t position);
 
 /**
  * Function: vector_delete
@@ -228,8 +408,47 @@ void vector_replace(vector_t *v, const void *elemAddr, uint_t position);
  * stays over-allocated.
  */
 
-void vector_delete(vector_t *v, uint_t position);
+void vector_delete(vector_t *v, size_t position);
   
+/**
+ * Function: vector_erase_range
+ * ----------------------------
+ * Deletes the n elements starting at the specified position from the vector_t.
+ * The vector_free_fun_t supplied to vector_new is called on each of them, then
+ * the elements after the range are shifted over once, as a whole block, to fill
+ * the gap.  An assert is raised if the range [position, position + n) is not
+ * within the logical length.  As vector_delete, it does not shrink the allocated
+ * size of the vector_t.
+ */
+
+void vector_erase_range(vector_t *v, size_t position, size_t n);
+
+/**
+ * Function: vector_remove_if
+ * --------------------------
+ * Removes from the vector_t every element for which pred_fun returns true,
+ * calling the vector_free_fun_t supplied to vector_new on each of them.  The
+ * remaining elements keep their relative order.  The vector_t is compacted in a
+ * single linear pass (pred_fun is called exactly once per element), which beats
+ * repeated calls to vector_delete.  Returns the number of removed elements.
+ * An assert is raised if pred_fun is NULL.
+ */
+
+size_t vector_remove_if(vector_t *v, vector_pred_fun_t pred_fun, void *auxData);
+
+/**
+ * Function: vector_dedup_sorted
+ * -----------------------------
+ * Removes the consecutive duplicates (as far as cmp_fun is concerned) of a
+ * vector_t, keeping the first element of each run of equal elements and
+ * calling the vector_free_fun_t on the others.  On a vector_t sorted with the
+ * same comparator, every element ends up unique.  Runs in a single linear
+ * pass and returns the number of removed elements.  An assert is raised if
+ * cmp_fun is NULL.
+ */
+
+size_t vector_dedup_sorted(vector_t *v, vector_cmp_fun_t cmp_fun);
+
 /**
  * Function: vector_search
  * ----------------------
@@ -240,10 +459,13 @@ void vector_delete(vector_t *v, uint_t position);
  * they should pass 0 as the startIndex.  The method will search from
  * there to the end of the vector_t.  The isSorted parameter allows the client 
  * to specify that the vector_t is already in sorted order, in which case vector_search
- * uses a faster binary search.  If isSorted is false, a simple linear search is 
- * used.  If a match is found, the position of the matching element is returned;
- * else the function returns -1.  Calling this function does not 
- * re-arrange or change contents of the vector_t or modify the key in any way.
+ * uses a faster binary search over [startIndex, logical length), and returns the
+ * first matching element from startIndex on.  For the binary search, the comparator
+ * is called with the key first and an element second (as for bsearch).  If isSorted
+ * is false, a simple linear search is used.  If a match is found, the position of
+ * the matching element is returned; else the function returns -1.  Calling this
+ * function does not re-arrange or change contents of the vector_t or modify the
+ * key in any way.
  * 
  * An assert is raised if startIndex is less than 0 or greater than
  * the logical length (although searching from logical length will never
@@ -252,7 +474,57 @@ void vector_delete(vector_t *v, uint_t position);
  * comparator or the key is NULL.
  */  
 
-int vector_search(const vector_t *v, const void *key, vector_cmp_fun_t search_fun, uint_t startIndex, bool isSorted);
+ptrdiff_t vector_search(const vector_t *v, const void *key, vector_cmp_fun_t search_fun, size_t startIndex, bool isSorted);
+
+/**
+ * Functions: vector_lower_bound, vector_upper_bound, vector_equal_range
+ * ---------------------------------------------------------------------
+ * Binary searches on a vector_t kept in ascending order according to cmp_fun
+ * (e.g. by vector_sort or vector_insert_sorted).  As for bsearch, cmp_fun is
+ * called with the key as first argument and an element as second argument.
+ *
+ * vector_lower_bound returns the position of the first element which is not
+ * less than the key, vector_upper_bound the position of the first element
+ * which is greater than the key; both return the logical length if there is
+ * no such element.  vector_equal_range sets [*first, *last) to the range of
+ * the elements equal to the key (an empty range at the insertion point if the
+ * key is not present).  They run in O(log n).  An assert is raised if cmp_fun
+ * is NULL.
+ */
+
+size_t vector_lower_bound(const vector_t *v, const void *key, vector_cmp_fun_t cmp_fun);
+
+size_t vector_upper_bound(const vector_t *v, const void *key, vector_cmp_fun_t cmp_fun);
+
+void vector_equal_range(const vector_t *v, const void *key, vector_cmp_fun_t cmp_fun,
+                        size_t *first, size_t *last);
+
+/**
+ * Function: vector_insert_sorted
+ * ------------------------------
+ * Inserts a new element into a vector_t kept in ascending order according to
+ * cmp_fun, at the position which preserves the ordering (after the elements
+ * equal to it, so equal elements stay in insertion order), and returns that
+ * position.  This keeps the vector_t sorted without ever calling vector_sort:
+ * the position is found in O(log n), the insertion shifts the tail once.
+ */
+
+size_t vector_insert_sorted(vector_t *v, const void *elemAddr, vector_cmp_fun_t cmp_fun);
+
+/**
+ * Function: vector_find_bytes
+ * ---------------------------
+ * Linear search for the first element, from startIndex on, whose bytes are
+ * all equal to the elem_size bytes at key (plain equality: no comparator is
+ * called, so this only suits elements without padding nor pointers to follow,
+ * such as integers or ids).  For elements of 1, 2, 4, 8 or 16 bytes the scan
+ * compares a whole SSE2 (or AVX2, when compiled for it) register of elements at
+ * once on x86-64; other sizes and platforms use a scalar loop.  Returns the
+ * position of the matching element or -1.  The startIndex and key are checked
+ * as for vector_search.
+ */
+
+ptrdiff_t vector_find_bytes(const vector_t *v, const void *key, size_t startIndex);
 
 /**
  * Function: vector_sort
@@ -264,6 +536,88 @@ int vector_search(const vector_t *v, const void *key, vector_cmp_fun_t search_fu
 
 void vector_sort(vector_t *v, vector_cmp_fun_t cmp_fun);
 
+/**
+ * Function: vector_sort_parallel
+ * ------------------------------
+ * Same as vector_sort (same comparator contract), but uses up to nthreads
+ * threads: the vector_t is partitioned into contiguous runs which are sorted
+ * concurrently, then the sorted runs are merged pairwise (each round of merges
+ * being done concurrently as well).  Passing 0 for nthreads uses one thread per
+ * online CPU.  Small vectors are simply sorted with vector_sort.  The merge needs
+ * a scratch buffer as large as the vector_t; if it cannot be allocated, the
+ * function falls back to vector_sort.  The comparator must be thread-safe.
+ * An assert is raised if the comparator is NULL.
+ */
+
+void vector_sort_parallel(vector_t *v, vector_cmp_fun_t cmp_fun, uint_t nthreads);
+
+/**
+ * Function: vector_radix_sort
+ * ---------------------------
+ * Sorts the vector_t into ascending order of the keys extracted by key_fun,
+ * where only the key_bits low-order bits of the keys are significant (1 to 64).
+ * This is a stable LSD radix sort, with one counting pass per 8-bit digit: it
+ * runs in linear time and calls key_fun exactly once per element, instead of
+ * calling a comparator O(n log n) times.  It needs scratch space for a copy of
+ * the elements and two keys per element.  Passes over digits shared by every
+ * key are skipped.  An assert is raised if key_fun is NULL or key_bits is not
+ * within [1, 64].
+ */
+
+void vector_radix_sort(vector_t *v, vector_key_fun_t key_fun, uint_t key_bits);
+
+/**
+ * Function: vector_sort_by_key
+ * ----------------------------
+ * Stable sort of the vector_t into ascending order of the keys of its
+ * elements.  key_fun is called exactly once per element to compute its key
+ * (key_size bytes) into a side array, next to the element's position; these
+ * (key, position) records are merge sorted with key_cmp, which compares two
+ * keys (with the vector_cmp_fun_t convention), then the elements are moved to
+ * their final position in place, along the cycles of the permutation.  Suits
+ * comparators that are expensive to run on the elements themselves (following
+ * pointers, computing things) and gives a deterministic order: equal keys keep
+ * their relative order.  It needs scratch space for two records per element.
+ * An assert is raised if key_fun or key_cmp is NULL, or key_size is 0.
+ */
+
+void vector_sort_by_key(vector_t *v, vector_extract_fun_t key_fun, size_t key_size,
+                        vector_cmp_fun_t key_cmp);
+
+/**
+ * Functions: vector_nth_element, vector_partial_sort, vector_topk
+ * ----------------------------------------------------------------
+ * Selection on a vector_t, for when only a few elements of the ordering
+ * (according to cmp_fun) matter, avoiding a full vector_sort.
+ *
+ * vector_nth_element rearranges the elements so that the element at position
+ * nth is the one which would be there if the vector_t were sorted, with no
+ * element greater than it before it, and none less than it after it.  It
+ * runs in O(n) on average (introselect: quickselect with a median of three
+ * pivot, switching to a heap based selection when the partitions go badly, so
+ * the worst case is O(n log n)).  An assert is raised if nth is not less than
+ * the logical length.
+ *
+ * vector_partial_sort moves the k smallest elements, in ascending order, to
+ * the first k positions; the order of the others is unspecified.  It runs in
+ * O(n log k) with a bounded heap.  An assert is raised if k is greater than
+ * the logical length.
+ *
+ * vector_topk appends to out the k greatest elements of v (all of them if
+ * there are fewer than k), greatest first, leaving v untouched.  It makes one
+ * pass over v keeping the best k elements seen so far in a heap, hence runs in
+ * O(n log k) with O(k) extra space.  out must have been constructed with the
+ * same element size; the elements are copied as vector_append does.
+ *
+ * An assert is raised if cmp_fun is NULL.
+ */
+
+void vector_nth_element(vector_t *v, size_t nth, vector_cmp_fun_t cmp_fun);
+
+void vector_partial_sort(vector_t *v, size_t k, vector_cmp_fun_t cmp_fun);
+
+void vector_topk(const vector_t *v, size_t k, vector_cmp_fun_t cmp_fun, vector_t *out);
+
 /**
  * Method: vector_map
  * -----------------
@@ -278,4 +632,84 @@ void vector_sort(vector_t *v, vector_cmp_fun_t cmp_fun);
 
 void vector_map(vector_t *v, vector_map_fun_t map_fun, void *auxData);
 
+/**
+ * Function: vector_map_parallel
+ * -----------------------------
+ * Same as vector_map, but the vector_t is split into (at most) nthreads
+ * contiguous chunks which are visited concurrently, each by its own thread
+ * (0 for nthreads means one thread per online CPU).  Within a chunk the elements
+ * are visited in order, but there is no ordering between chunks: map_fun must
+ * be thread-safe, i.e. only touch the element it is given or synchronize its
+ * accesses to auxData.  An assert is raised if map_fun is NULL.
+ */
+
+void vector_map_parallel(vector_t *v, vector_map_fun_t map_fun, void *auxData, uint_t nthreads);
+
+/**
+ * Function: vector_reduce
+ * -----------------------
+ * Folds the elements of the vector_t in order (from element 0 to element n-1)
+ * into the accumulator at accAddr, calling reduce_fun(accAddr, elemAddr, auxData)
+ * on each element.  The accumulator must be initialized by the client.
+ * An assert is raised if accAddr or reduce_fun is NULL.
+ */
+
+void vector_reduce(const vector_t *v, void *accAddr, vector_reduce_fun_t reduce_fun, void *auxData);
+
+/**
+ * Function: vector_reduce_parallel
+ * --------------------------------
+ * Parallel version of vector_reduce: the vector_t is split into (at most)
+ * nthreads contiguous chunks (0 means one per online CPU), each one folded by
+ * its own thread into a per-thread partial accumulator of accSize bytes.  The
+ * partial accumulators are then merged into *accAddr, in the order of the chunks,
+ * with combine_fun.  On entry *accAddr must hold the identity of combine_fun
+ * (e.g. 0 for a sum, 1 for a product) since every partial accumulator starts
+ * as a copy of it.  combine_fun must be associative; reduce_fun must be
+ * thread-safe with respect to auxData.  An assert is raised if any of accAddr,
+ * reduce_fun or combine_fun is NULL, or accSize is 0.
+ */
+
+void vector_reduce_parallel(const vector_t *v, void *accAddr, size_t accSize,
+                            vector_reduce_fun_t reduce_fun, vector_combine_fun_t combine_fun,
+                            void *auxData, uint_t nthreads);
+
+/**
+ * Function: vector_save
+ * ---------------------
+ * Writes the elements of the vector_t to the file at path (created or
+ * truncated), as a small header (format version, elem_size, count) followed
+ * by the contiguous element storage, so that vector_open_mmap can use it as is.
+ * Only meaningful for plain old data elements: pointers embedded in the
+ * elements are saved as raw addresses.  The file uses the native byte order.
+ * Returns true on success, false (with errno set) if the file could not be
+ * written.
+ */
+
+bool vector_save(const vector_t *v, const char *path);
+
+/**
+ * Function: vector_open_mmap
+ * --------------------------
+ * Constructs a raw (or previously destroyed) vector_t from a file written by
+ * vector_save, by mapping the file in memory: there is no parsing nor copying,
+ * the pages are loaded lazily by the system as elements are accessed.  The
+ * elem_size comes from the file, the free_fun is NULL.  Every vector_t function
+ * works unchanged on the mapped storage.
+ *
+ * If readonly is true, the file is never written: the mapping is private, so
+ * the vector_t can still be modified (pages are copied on write).  Otherwise
+ * the mapping is shared and in-place updates (vector_replace, vector_sort,
+ * vector_delete, ...) go straight to the file, whose element count is updated
+ * on vector_dispose.  Growing the vector_t beyond the mapped elements (or
+ * vector_shrink_to_fit) moves the elements to the heap and unmaps the file;
+ * later updates are not written back, use vector_save for that.
+ *
+ * Returns true on success, false (with errno set on system errors) if the file
+ * cannot be opened or mapped, or is not a valid vector_save file; the vector_t
+ * is then left untouched.
+ */
+
+bool vector_open_mmap(vector_t *v, const char *path, bool readonly);
+
 #endif
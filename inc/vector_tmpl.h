@@ -0,0 +1,215 @@
+/**
+ * File: vector_tmpl.h
+ * --------------------
+ * Defines macro "templates" generating type-specialized vectors.
+ *
+ * The vector_t of vector.h stores elements of any size behind (void *) ptrs:
+ * every access pays a runtime elem_size multiply and every sort/search an
+ * indirect call through a vector_cmp_fun_t.  For hot loops over vectors of
+ * int, double, pointers, ... this header generates a vector type dedicated to
+ * one element type T, where sizeof(T) and the ordering are known at compile
+ * time, so that the compiler can inline, unroll and vectorize.
+ *
+ * Usage:  VECTOR_DEFINE(intvec, int)      // at file scope
+ *         ...
+ *         intvec_t v;
+ *         intvec_new(&v, 0);
+ *         intvec_push(&v, 42);
+ *         intvec_sort(&v);
+ *         int x = *intvec_at(&v, 0);
+ *         intvec_dispose(&v);
+ *
+ * VECTOR_DEFINE(name, T) generates the type name_t and the functions below,
+ * all static inline (so the macro can be used in several translation units):
+ *
+ *   void   name_new(name_t *v, size_t initAlloc);
+ *   void   name_dispose(name_t *v);
+ *   size_t name_len(const name_t *v);
+ *   size_t name_capacity(const name_t *v);
+ *   void   name_reserve(name_t *v, size_t n);
+ *   T     *name_at(const name_t *v, size_t position);
+ *   void   name_push(name_t *v, T elem);
+ *   void   name_sort(name_t *v);
+ *
+ * They follow the semantics of their vector.h counterparts (vector_new,
+ * vector_dispose, vector_len, vector_capacity, vector_reserve, vector_nth,
+ * vector_append and vector_sort), except that elements are passed by value and
+ * there is no free function: the elements are plain values.
+ *
+ * name_sort orders the elements with the ordering macro VECTOR_LESS, i.e. the
+ * built-in < operator, which suits arithmetic and pointer types.  For other
+ * types (structs, ...) or another ordering, use VECTOR_DEFINE_CMP(name, T, less)
+ * where less(a, b) is a function or function-like macro taking two T values and
+ * returning non zero if a must come before b.  name_sort is an introsort (a
+ * quicksort falling back to a heapsort past 2 log2(n) partitions), so it runs
+ * in O(n log n) even on adversarial inputs; like vector_sort, it is not stable.
+ */
+
+#ifndef _vector_tmpl_
+#define _vector_tmpl_
+
+#include "vector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+
+#define VECTOR_LESS(a, b) ((a) < (b))
+
+// more than SIZE_MAX bytes of elements: same failure as vector_t
+static inline void vector_tmpl_overflow_(void) {
+  errno = ENOMEM;
+  perror("vector size overflow");
+  exit(EXIT_FAILURE);
+}
+
+// below this many elements, name_sort switches to an insertion sort
+#define VECTOR_TMPL_SMALL_SORT 16
+
+#define VECTOR_DEFINE(name, T) VECTOR_DEFINE_CMP(name, T, VECTOR_LESS)
+
+#define VECTOR_DEFINE_CMP(name, T, less)                                      \
+                                                                              \
+typedef struct {                                                              \
+  T      *headptr;                                                            \
+  size_t size;                                                                \
+  size_t chunk_size;                                                          \
+  size_t capacity;                                                            \
+} name##_t;                                                                   \
+                                                                              \
+static inline void name##_new(name##_t *v, size_t initAlloc) {                \
+  v->headptr    = NULL;                                                       \
+  v->size       = 0;                                                          \
+  v->chunk_size = (initAlloc > 0) ? initAlloc : 8;                            \
+  v->capacity   = 0;                                                          \
+}                                                                             \
+                                                                              \
+static inline void name##_dispose(name##_t *v) {                              \
+  free(v->headptr);                                                           \
+  v->headptr  = NULL;                                                         \
+  v->size     = v->capacity = 0;                                              \
+}                                                                             \
+                                                                              \
+static inline size_t name##_len(const name##_t *v) {                          \
+  return v->size;                                                             \
+}                                                                             \
+                                                                              \
+static inline size_t name##_capacity(const name##_t *v) {                     \
+  return v->capacity;                                                         \
+}                                                                             \
+                                                                              \
+static inline void name##_set_capacity_(name##_t *v, size_t capacity) {       \
+  if (capacity > SIZE_MAX / sizeof(T))                                        \
+    vector_tmpl_overflow_();                                                  \
+  T *ptr = (T *) realloc(v->headptr, capacity * sizeof(T));                   \
+  if (ptr == NULL) {                                                          \
+    perror("could not allocate space for the " #name " chunk");               \
+    exit(EXIT_FAILURE);                                                       \
+  }                                                                           \
+  v->headptr  = ptr;                                                          \
+  v->capacity = capacity;                                                     \
+}                                                                             \
+                                                                              \
+static inline void name##_reserve(name##_t *v, size_t n) {                    \
+  if (n > v->capacity)                                                        \
+    name##_set_capacity_(v, n);                                               \
+}                                                                             \
+                                                                              \
+static inline T *name##_at(const name##_t *v, size_t position) {              \
+  assert(position < v->size);                                                 \
+  return v->headptr + position;                                               \
+}                                                                             \
+                                                                              \
+static inline void name##_push(name##_t *v, T elem) {                         \
+  if (v->size == v->capacity) {                                               \
+    /* same geometric growth as vector_append */                              \
+    size_t step = (v->capacity > v->chunk_size) ? v->capacity : v->chunk_size;\
+    size_t max_capacity = SIZE_MAX / sizeof(T);                               \
+    if (step > max_capacity - v->capacity)                                    \
+      step = max_capacity - v->capacity;                                      \
+    if (step == 0)                                                            \
+      vector_tmpl_overflow_();                                                \
+    name##_set_capacity_(v, v->capacity + step);                              \
+  }                                                                           \
+  v->headptr[v->size++] = elem;                                               \
+}                                                                             \
+                                                                              \
+static inline void name##_isort_(T *lo, T *hi) {                              \
+  for (T *p = lo + 1; p < hi; p++) {                                          \
+    T elem = *p;                                                              \
+    T *q = p;                                                                 \
+    for (; q > lo && less(elem, q[-1]); q--)                                  \
+      *q = q[-1];                                                             \
+    *q = elem;                                                                \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static inline void name##_sift_down_(T *base, size_t pos, size_t n) {        \
+  /* max-heap on base[0, n): sinks base[pos] to its place */                  \
+  T elem = base[pos];                                                         \
+  for (size_t child; (child = 2 * pos + 1) < n; pos = child) {                \
+    if (child + 1 < n && less(base[child], base[child + 1]))                  \
+      child++;                                                                \
+    if (!less(elem, base[child]))                                             \
+      break;                                                                  \
+    base[pos] = base[child];                                                  \
+  }                                                                           \
+  base[pos] = elem;                                                           \
+}                                                                             \
+                                                                              \
+static inline void name##_heapsort_(T *lo, T *hi) {                           \
+  size_t n = hi - lo;                                                         \
+  for (size_t pos = n / 2; pos > 0; pos--)                                    \
+    name##_sift_down_(lo, pos - 1, n);                                        \
+  while (n > 1) {                                                             \
+    T tmp = lo[0]; lo[0] = lo[n - 1]; lo[n - 1] = tmp;                        \
+    name##_sift_down_(lo, 0, --n);                                            \
+  }                                                                           \
+}                                                                             \
+                                                                              \
+static inline void name##_qsort_(T *lo, T *hi, size_t depth) {                \
+  /* introsort on [lo, hi): quicksort, recursing on the smaller partition    \
+     only, and heapsort on a range still unsorted after depth partitions */  \
+  while (hi - lo > VECTOR_TMPL_SMALL_SORT) {                                  \
+    if (depth-- == 0) {                                                       \
+      name##_heapsort_(lo, hi);                                               \
+      return;                                                                 \
+    }                                                                         \
+    T *mid = lo + (hi - lo) / 2, *last = hi - 1, tmp;                         \
+    /* median of three, which also plants sentinels at lo and last */        \
+    if (less(*mid, *lo))   { tmp = *mid;  *mid  = *lo;  *lo  = tmp; }         \
+    if (less(*last, *mid)) { tmp = *last; *last = *mid; *mid = tmp;           \
+      if (less(*mid, *lo)) { tmp = *mid;  *mid  = *lo;  *lo  = tmp; }         \
+    }                                                                         \
+    T pivot = *mid;                                                           \
+    T *i = lo, *j = last;                                                     \
+    for (;;) {                                                                \
+      do i++; while (less(*i, pivot));                                        \
+      do j--; while (less(pivot, *j));                                        \
+      if (i >= j) break;                                                      \
+      tmp = *i; *i = *j; *j = tmp;                                            \
+    }                                                                         \
+    /* [lo, j] <= pivot <= [j + 1, hi) */                                     \
+    if (j + 1 - lo < hi - (j + 1)) {                                          \
+      name##_qsort_(lo, j + 1, depth);                                        \
+      lo = j + 1;                                                             \
+    }                                                                         \
+    else {                                                                    \
+      name##_qsort_(j + 1, hi, depth);                                        \
+      hi = j + 1;                                                             \
+    }                                                                         \
+  }                                                                           \
+  name##_isort_(lo, hi);                                                      \
+}                                                                             \
+                                                                              \
+static inline void name##_sort(name##_t *v) {                                 \
+  /* depth limit of 2 log2(n), as vector_nth_element */                       \
+  size_t depth = 0;                                                           \
+  for (size_t n = v->size; n > 1; n >>= 1)                                    \
+    depth += 2;                                                               \
+  if (v->size > 1)                                                            \
+    name##_qsort_(v->headptr, v->headptr + v->size, depth);                   \
+}
+
+#endif
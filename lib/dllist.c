@@ -10,14 +10,9 @@
 
 #include "dllist.h"
 #include "my_malloc.h"
+#include "trace.h"
 
-// the actual data structure
-
-struct dllitm_ {
-  void *data;
-  struct dllitm_ *next;
-  struct dllitm_ *prev;
-};
+// the actual data structure (struct dllitm_ is in dllist.h)
 
 struct dllist_ {
   unsigned int size;
@@ -28,6 +23,8 @@ struct dllist_ {
 
   dllitm_t *head;
   dllitm_t *tail;
+  //
+  const allocator_t *alloc;      // where the items (and the list itself) come from
 };
 
 /*
@@ -59,9 +56,19 @@ bool dllist_new(dllist_t **lst,
              int (*match)(const void *k1, const void *k2), 
              void (*destroy)(void *data),
              void (*cb)(const void *data)) {
+  return dllist_new_with(lst, match, destroy, cb, NULL);
+}
+
+bool dllist_new_with(dllist_t **lst, 
+                     int (*match)(const void *k1, const void *k2), 
+                     void (*destroy)(void *data),
+                     void (*cb)(const void *data),
+                     const allocator_t *alloc) {
   //
-  *lst = xmalloc0(sizeof(dllist_t));   // exit with an error if lst is NULL
+  alloc = allocator_or_default(alloc);
+  *lst = xalloc0(alloc, sizeof(dllist_t));   // exit with an error if lst is NULL
   //
+  (*lst)->alloc   = alloc;
   (*lst)->size    = 0;
   (*lst)->match   = match;
   (*lst)->destroy = destroy;
@@ -71,37 +78,38 @@ bool dllist_new(dllist_t **lst,
 }
 
 void dllist_free(dllist_t **lst) {
-  printf("[%s] entry \n", __FUNCTION__);
+  TRACE_DEBUG("entry");
   if ((*lst)->destroy != NULL) {
     while ((*lst)->size > 0) {
-      printf("[%s] loop over the list item - current size is %d\n", __FILE__, (*lst)->size);
+      TRACE_DEBUG("loop over the list item - current size is %d", (*lst)->size);
       dllitm_t *p = (*lst)->head;
       (*lst)->head = p->next;
       (*lst)->destroy(p->data); // call the user function
-      free(p);
+      xfree((*lst)->alloc, p, sizeof(dllitm_t));
       (*lst)->size--;
     }
   }
   else {  
     while ((*lst)->size > 0) {
-      printf("[%s] loop over the list item - current size is %d\n", __FILE__, (*lst)->size);
+      TRACE_DEBUG("loop over the list item - current size is %d", (*lst)->size);
       dllitm_t *p = (*lst)->head;
       (*lst)->head = p->next;
-      free(p);
+      xfree((*lst)->alloc, p, sizeof(dllitm_t));
       (*lst)->size--;
     }
   }
+  const allocator_t *alloc = (*lst)->alloc;
   memset(*lst, 0, sizeof(dllist_t));
-  free(*lst);
+  xfree(alloc, *lst, sizeof(dllist_t));
   *lst = NULL;
-  printf("[%s] exit \n", __FUNCTION__);
+  TRACE_DEBUG("exit");
   return;
 }
 
 bool dllist_ins_next(dllist_t *lst, dllitm_t *itm, const void *data) {
   //
-  printf("[%s] entry \n", __FUNCTION__);
-  dllitm_t *plitm = xmalloc0(sizeof(dllitm_t)); // exit with an error if plitm is NULL
+  TRACE_DEBUG("entry");
+  dllitm_t *plitm = xalloc0(lst->alloc, sizeof(dllitm_t)); // exit with an error if plitm is NULL
   // OK now, cast to avoid warning: assigning to 'void *' from 'const void *' discards qualifiers
   plitm->data = (void *) data;
   // insertion - 4 cases
@@ -110,7 +118,7 @@ bool dllist_ins_next(dllist_t *lst, dllitm_t *itm, const void *data) {
     plitm->next = NULL; // or  lst->tail;
     plitm->prev = NULL; // lst->head;
     lst->tail = lst->head = plitm;
-    printf("[%s] case empty list \n", __FUNCTION__);
+    TRACE_DEBUG("case empty list");
   }
   else if (itm == NULL) {
     // (2) dllist_size >0 => list is not empty, but itm == NULL
@@ -119,7 +127,7 @@ bool dllist_ins_next(dllist_t *lst, dllitm_t *itm, const void *data) {
     plitm->prev = NULL;
     lst->head->prev = plitm; 
     lst->head   = plitm;
-    printf("[%s] case insert at head position \n", __FUNCTION__);
+    TRACE_DEBUG("case insert at head position");
   }
   else {
     // (3) and (4)
@@ -161,16 +169,16 @@ bool dllist_rem_next(dllist_t *lst, dllitm_t *itm, void **data) {
     //
     del->next = del->prev = NULL;
     *data = del->data; // make the data available
-    free(del);         // free th space taken by this cell
+    xfree(lst->alloc, del, sizeof(dllitm_t));  // free th space taken by this cell
     lst->size--;
     return true;
   }
  }
 
 bool dllist_rem(dllist_t *lst, void **data) {
-  printf("[%s] entry \n", __FUNCTION__);
+  TRACE_DEBUG("entry");
   if (lst->size == 0) {
-    printf("[%s] exit - case empty list\n", __FUNCTION__);
+    TRACE_DEBUG("exit - case empty list");
     return false;
   }
   bool found = false;
@@ -190,7 +198,7 @@ bool dllist_rem(dllist_t *lst, void **data) {
       lst->head->prev = NULL;
     }
     else if (pcur == lst->tail) {
-      printf("[%s] exit - general case - tail deletion\n", __FUNCTION__);
+      TRACE_DEBUG("exit - general case - tail deletion");
       lst->tail = lst->tail->prev;
       lst->tail->next = NULL;
     }
@@ -198,14 +206,14 @@ bool dllist_rem(dllist_t *lst, void **data) {
       pcur->next->prev = pcur->prev;
       pcur->prev->next = pcur->next;
     }
-    free(pcur);
+    xfree(lst->alloc, pcur, sizeof(dllitm_t));
     pcur = NULL;
     lst->size--;
-    printf("[%s] exit - general case - item located and deleted\n", __FUNCTION__);
+    TRACE_DEBUG("exit - general case - item located and deleted");
     return true;
   }
   else {
-    printf("[%s] exit - general case - item not found and therefore not deleted\n", __FUNCTION__);
+    TRACE_DEBUG("exit - general case - item not found and therefore not deleted");
     return false;
   }
 }
@@ -213,17 +221,17 @@ bool dllist_rem(dllist_t *lst, void **data) {
 bool dllist_find(const dllist_t *lst, const void *data, dllitm_t **itm) {
   *itm = NULL;
   if (lst->size == 0) {
-    printf("[%s] exit - case empty list - item NOT found\n", __FUNCTION__);
+    TRACE_DEBUG("exit - case empty list - item NOT found");
     return false;
   }
   else if (lst->size == 1) {
     if (lst->match(data, lst->head->data) == 0) {
       *itm = lst->head;
-      printf("[%s] exit - case list singleton - item found\n", __FUNCTION__);
+      TRACE_DEBUG("exit - case list singleton - item found");
       return true;        
     }
     else {
-      printf("[%s] exit - case list singleton - item NOT found\n", __FUNCTION__);
+      TRACE_DEBUG("exit - case list singleton - item NOT found");
       return false;
     }
   } 
@@ -231,7 +239,7 @@ bool dllist_find(const dllist_t *lst, const void *data, dllitm_t **itm) {
   for(dllitm_t *pcur = lst->head; pcur != NULL; pcur = pcur->next) {
     if (lst->match(data, pcur->data) == 0) {
       *itm = pcur;
-      printf("[%s] exit - general case - item found\n", __FUNCTION__);
+      TRACE_DEBUG("exit - general case - item found");
       found = true;
       break;        
     }
@@ -260,16 +268,5 @@ dllitm_t *dllist_tail(const dllist_t *lst) {
   return lst->tail;
 }
 
-void *dllist_data(const dllitm_t *itm) {
-  return itm->data;
-}
-
-dllitm_t *dllist_next(const dllitm_t *itm) {
-  return itm->next;
-}
-
-dllitm_t *dllist_prev(const dllitm_t *itm) {
-  return itm->prev;
-}
 
 
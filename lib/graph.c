@@ -19,7 +19,7 @@ int wr_graph_new(args_t in) {
   void (*arg_lcb)(const void *) = (in.lcb != NULL) ? in.lcb : NULL;
   bool arg_directed = in.directed ? in.directed : true;
   
-  return graph_new_base(in.graph, arg_match, arg_destroy, arg_cb, arg_lcb, arg_directed);
+  return graph_new_base(in.graph, arg_match, arg_destroy, arg_cb, arg_lcb, arg_directed, in.alloc);
 }
 
 
@@ -31,7 +31,7 @@ void wr_graph_init(args_t in) {
   void (*arg_lcb)(const void *) = (in.lcb != NULL) ? in.lcb : NULL;
   bool arg_directed = in.directed ? in.directed : true;
 
-  graph_init_base(*in.graph, arg_match, arg_destroy, arg_cb, arg_lcb, arg_directed);
+  graph_init_base(*in.graph, arg_match, arg_destroy, arg_cb, arg_lcb, arg_directed, in.alloc);
 }
 
 
@@ -40,11 +40,12 @@ int graph_new_base(graph_t **graph,
                    void (*destroy)(void *data),
                    void (*cb)(const void *pdata),
                    void (*lcb)(const void *pdata),
-                   bool directed) {
+                   bool directed,
+                   const allocator_t *alloc) {
   
-  *graph = xmalloc0(sizeof(graph_t));
+  *graph = xalloc0(alloc, sizeof(graph_t));
 
-  graph_init_base(*graph, match, destroy, cb, lcb, directed);
+  graph_init_base(*graph, match, destroy, cb, lcb, directed, alloc);
   return 0;
 }
 
@@ -54,7 +55,8 @@ void graph_init_base(graph_t *graph,
                      void (*destroy)(void *data),
                      void (*cb)(const void *pdata),
                      void (*lcb)(const void *pdata),
-                     bool directed) {
+                     bool directed,
+                     const allocator_t *alloc) {
 
   graph->vcount   = 0;
   graph->ecount   = 0;
@@ -63,14 +65,16 @@ void graph_init_base(graph_t *graph,
   graph->cb       = cb;
   graph->lcb      = lcb;
   graph->directed = directed;
+  graph->alloc    = allocator_or_default(alloc);
 
-  list_init(&graph->adjlists, match, NULL, lcb);
+  list_init_with(&graph->adjlists, match, NULL, lcb, graph->alloc);
 }
 
 
 void graph_free(graph_t **graph) {
   // destroy the adjlists
   sllist_t *adjlsts = &(*graph)->adjlists;  
+  const allocator_t *alloc = (*graph)->alloc;
 
   // remove vertices and their adjacency lists
   while (list_size(adjlsts) > 0) {
@@ -79,19 +83,20 @@ void graph_free(graph_t **graph) {
     // remove vertex
     if (list_rem_next(adjlsts, NULL, (void **) &adjlst) == 0) {
 
-      // remove adjacency list of this vertex
-      sllist_t *pl = &adjlst->adjacent;
-      list_free(&pl);
+      // remove adjacency list of this vertex (embedded in adjlst, so
+      // it is only emptied)
+      list_clear(&adjlst->adjacent);
       
       if ((*graph)->destroy != NULL)
         (*graph)->destroy(adjlst->vertex);
 
-      free(adjlst); 
+      xfree((*graph)->alloc, adjlst, sizeof(adjlist_t)); 
     }
   } 
   //
-  list_free(&adjlsts);
+  list_clear(adjlsts);
   memset(*graph, 0, sizeof(graph_t));
+  xfree(alloc, *graph, sizeof(graph_t));
   // 
   *graph = NULL;
   return;
@@ -126,13 +131,13 @@ int graph_ins_vertex(graph_t *graph, const void *data) {
   int rval;
 
   // do the alloc and check if OK or not
-  adjlst = xmalloc0(sizeof(adjlist_t));
+  adjlst = xalloc0(graph->alloc, sizeof(adjlist_t));
 
   // malloc OK, add the vertex
   adjlst->vertex = (void *) data;
   
   // init the adjacency list
-  list_init(&adjlst->adjacent, graph->match, NULL, graph->lcb);  // no destroy here
+  list_init_with(&adjlst->adjacent, graph->match, NULL, graph->lcb, graph->alloc);  // no destroy here
  
   // update the graph adjlists with newly addded adjlst (adjacency list)
   if ((rval = list_ins_next(&graph->adjlists, list_tail(&graph->adjlists), adjlst)) != 0) 
@@ -201,7 +206,7 @@ int graph_rem_vertex(graph_t *graph, void **data) {
 
     if (list_rem_next(adjlsts, ppl, (void **) &adjlst) == 0) {
       *data = adjlst->vertex;
-      free(adjlst);
+      xfree(graph->alloc, adjlst, sizeof(adjlist_t));
       --graph->vcount;
       return 0;
     }
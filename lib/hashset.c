@@ -3,102 +3,529 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <errno.h>
 
-void hashset_new(hashset_t *h, int elemSize, int numBuckets,
+void hashset_new(hashset_t *h, size_t elemSize, size_t numBuckets,
                  hashset_hash_fun_t hashfn, 
                  hashset_cmp_fun_t cmpfn, 
                  hashset_free_fun_t freefn) {
+  hashset_new_with(h, elemSize, numBuckets, hashfn, cmpfn, freefn, NULL);
+}
+
+void hashset_new_with(hashset_t *h, size_t elemSize, size_t numBuckets,
+                      hashset_hash_fun_t hashfn,
+                      hashset_cmp_fun_t cmpfn,
+                      hashset_free_fun_t freefn,
+                      const allocator_t *alloc) {
+  hashset_new_engine(h, HASHSET_CHAINED, elemSize, numBuckets, hashfn, cmpfn, freefn, alloc);
+}
+
+/*
+ * Entries
+ * -------
+ * Both engines store entries rather than bare elements: the element, then its
+ * full width hash code (from hash64_fun, or hash_fun called with SIZE_MAX
+ * buckets) at hash_offset, a multiple of sizeof(uint64_t).  The bucket of an
+ * element is derived from its hash code alone (hashset_bucket: the low bits
+ * with hash64_fun, whose tables have a power of two number of buckets, the
+ * code modulo the number of buckets otherwise), so a rehash reuses the cached
+ * code and never calls hashfn again; and a search only calls cmp_fun on the
+ * elements whose hash code is the one of the key.  The element comes first, so the address
+ * of an entry is the address of its element.
+ */
+
+static inline uint64_t hashset_hash(const hashset_t *h, const void *elemAddr) {
+  if (h->hash64_fun != NULL)
+    return h->hash64_fun(elemAddr);
+  return h->hash_fun(elemAddr, SIZE_MAX);
+}
+
+static inline size_t hashset_bucket(const hashset_t *h, uint64_t hash, size_t numBuckets) {
+  if (h->hash64_fun != NULL)
+    return (size_t) hash & (numBuckets - 1);
+  return (size_t) (hash % numBuckets);
+}
+
+static inline uint64_t *entry_hash(const hashset_t *h, const void *entry) {
+  return (uint64_t *) ((char *) entry + h->hash_offset);
+}
+
+static inline bool entry_matches(const hashset_t *h, const void *entry, const void *elemAddr, uint64_t hash) {
+  return *entry_hash(h, entry) == hash && h->cmp_fun(elemAddr, entry) == 0;
+}
+
+/*
+ * Robin Hood engine
+ * -----------------
+ * Slot k holds an element iff probe_len[k] != 0, probe_len[k] - 1 being the
+ * distance from the element's home slot (its hash code modulo num_buckets) to
+ * k, going forward and wrapping around.  Along a probe sequence the distances
+ * of the residents never fall behind the one of the element being probed for
+ * by more than one per slot, hence the early exit of rh_find.
+ */
+
+static void *rh_calloc(const hashset_t *h, size_t n, size_t sz) {
+  void *p = NULL;
+  if (n <= SIZE_MAX / sz)
+    p = h->alloc->alloc(h->alloc->ctx, n * sz);
+  if (p == NULL) {
+    perror("could not allocate memory for the hashset_t");
+    exit(EXIT_FAILURE);
+  }
+  memset(p, 0, n * sz);
+  return p;
+}
+
+static void rh_alloc_table(hashset_t *h, size_t numSlots) {
+  h->num_buckets = numSlots;
+  h->slots       = rh_calloc(h, numSlots, h->entry_size);
+  h->probe_len   = rh_calloc(h, numSlots, sizeof(uint32_t));
+}
+
+static void rh_free_table(hashset_t *h, char *slots, uint32_t *probe_len, size_t numSlots) {
+  h->alloc->free(h->alloc->ctx, slots, numSlots * h->entry_size);
+  h->alloc->free(h->alloc->ctx, probe_len, numSlots * sizeof(uint32_t));
+}
+
+static inline char *rh_slot(const hashset_t *h, size_t k) {
+  return h->slots + k * h->entry_size;
+}
+
+// the slot of the element matching elemAddr (of hash code hash), or -1
+static ptrdiff_t rh_find(const hashset_t *h, const void *elemAddr, uint64_t hash) {
+  size_t k = hashset_bucket(h, hash, h->num_buckets);
+  for (uint32_t len = 1; len <= h->probe_len[k]; len++) {
+    if (h->probe_len[k] == len && entry_matches(h, rh_slot(h, k), elemAddr, hash))
+      return k;
+    if (++k == h->num_buckets)
+      k = 0;
+  }
+  return -1;
+}
+
+// enters the entry at entryAddr, whose element is known not to be in the table yet
+static void rh_insert(hashset_t *h, const void *entryAddr) {
+  size_t k = hashset_bucket(h, *entry_hash(h, entryAddr), h->num_buckets);
+  uint32_t len = 1;
+  memcpy(h->tmp, entryAddr, h->entry_size);
+  while (h->probe_len[k] != 0) {
+    if (h->probe_len[k] < len) {
+      // the resident is closer to home: it gives up its slot to the carried
+      // entry and is carried on in its place
+      char *p_slot = rh_slot(h, k), *p_swap = (char *) h->tmp + h->entry_size;
+      memcpy(p_swap, p_slot, h->entry_size);
+      memcpy(p_slot, h->tmp, h->entry_size);
+      memcpy(h->tmp, p_swap, h->entry_size);
+      uint32_t l = h->probe_len[k];
+      h->probe_len[k] = len;
+      len = l;
+    }
+    if (++k == h->num_buckets)
+      k = 0;
+    len++;
+  }
+  memcpy(rh_slot(h, k), h->tmp, h->entry_size);
+  h->probe_len[k] = len;
+}
+
+static void rh_resize(hashset_t *h, size_t numSlots) {
+  char *old_slots = h->slots;
+  uint32_t *old_probe_len = h->probe_len;
+  size_t old_num = h->num_buckets;
+  rh_alloc_table(h, numSlots);
+  for (size_t k = 0; k < old_num; k++)
+    if (old_probe_len[k] != 0)
+      rh_insert(h, old_slots + k * h->entry_size);
+  rh_free_table(h, old_slots, old_probe_len, old_num);
+}
+
+/*
+ * Chained engine
+ * --------------
+ */
+
+static vector_t *chained_alloc_buckets(hashset_t *h, size_t numBuckets) {
+  // need to allocate room for numBuckets of type vector_t
+  vector_t *buckets = NULL;
+  if (numBuckets <= SIZE_MAX / sizeof(vector_t))
+    buckets = h->alloc->alloc(h->alloc->ctx, numBuckets * sizeof(vector_t));
+  if (buckets == NULL) {
+    perror("could not allocate memory for the hashset_t");
+    exit(EXIT_FAILURE);
+  }
+  for(size_t ix_bucket = 0; ix_bucket < numBuckets; ix_bucket++)
+    vector_new_with(&buckets[ix_bucket], h->entry_size, h->free_fun, h->chunk_size, h->alloc);
+  return buckets;
+}
+
+/*
+ * Resizing moves the elements of the old buckets (the old table) to the new
+ * ones bucket by bucket, in order: old buckets below rehash_pos have moved.
+ * A stop-the-world resize moves them all at once; in incremental mode, every
+ * hashset_enter and hashset_lookup moves a few (chained_rehash_step) while
+ * both tables stay live, an element being in its old bucket as long as that
+ * bucket has not moved, and in its new bucket afterwards.
+ */
+
+// non-empty old buckets moved per step, and old buckets visited at most
+// (both raised to rehash_step when the next growth is near)
+static const size_t kRehashStep       = 4;
+static const size_t kRehashMaxVisited = 10 * 4;
+
+static void chained_migrate_bucket(hashset_t *h, vector_t *v) {
+  for (size_t ix = 0; ix < vector_len(v); ix++) {
+    const void *p_entry = vector_nth(v, ix);
+    vector_append(&h->bucket_lst[hashset_bucket(h, *entry_hash(h, p_entry), h->num_buckets)], p_entry);
+  }
+  // the elements moved to the new buckets: they must not be freed
+  v->free_fun = NULL;
+  vector_dispose(v);
+}
+
+static void chained_end_rehash(hashset_t *h) {
+  h->alloc->free(h->alloc->ctx, h->old_bucket_lst, h->old_num_buckets * sizeof(vector_t));
+  h->old_bucket_lst  = NULL;
+  h->old_num_buckets = 0;
+  h->rehash_pos      = 0;
+}
+
+static void chained_finish_rehash(hashset_t *h) {
+  if (h->old_bucket_lst == NULL)
+    return;
+  while (h->rehash_pos < h->old_num_buckets)
+    chained_migrate_bucket(h, &h->old_bucket_lst[h->rehash_pos++]);
+  chained_end_rehash(h);
+}
+
+static void chained_rehash_step(hashset_t *h) {
+  if (h->old_bucket_lst == NULL)
+    return;
+  size_t moved = 0, visited = 0;
+  size_t max_moved   = (h->rehash_step > kRehashStep) ? h->rehash_step : kRehashStep;
+  size_t max_visited = (h->rehash_step > kRehashMaxVisited) ? h->rehash_step : kRehashMaxVisited;
+  while (h->rehash_pos < h->old_num_buckets && moved < max_moved && visited < max_visited) {
+    vector_t *v = &h->old_bucket_lst[h->rehash_pos++];
+    if (vector_len(v) > 0)
+      moved++;
+    chained_migrate_bucket(h, v);
+    visited++;
+  }
+  if (h->rehash_pos == h->old_num_buckets)
+    chained_end_rehash(h);
+}
+
+static void chained_start_rehash(hashset_t *h, size_t numBuckets) {
+  chained_finish_rehash(h);
+  h->old_bucket_lst  = h->bucket_lst;
+  h->old_num_buckets = h->num_buckets;
+  h->rehash_pos      = 0;
+  h->bucket_lst      = chained_alloc_buckets(h, numBuckets);
+  h->num_buckets     = numBuckets;
+}
+
+static void chained_resize(hashset_t *h, size_t numBuckets) {
+  chained_start_rehash(h, numBuckets);
+  chained_finish_rehash(h);
+}
+
+// the bucket holding the element of hash code hash, if any
+static vector_t *chained_bucket(const hashset_t *h, uint64_t hash) {
+  if (h->old_bucket_lst != NULL) {
+    size_t old_num = hashset_bucket(h, hash, h->old_num_buckets);
+    if (old_num >= h->rehash_pos)
+      return &h->old_bucket_lst[old_num];
+  }
+  return &h->bucket_lst[hashset_bucket(h, hash, h->num_buckets)];
+}
+
+// the position in v of the element matching elemAddr, or -1
+static ptrdiff_t chained_find(const hashset_t *h, const vector_t *v, const void *elemAddr, uint64_t hash) {
+  const char *p_entry = vector_data(v);
+  for (size_t ix = 0; ix < vector_len(v); ix++, p_entry += h->entry_size)
+    if (entry_matches(h, p_entry, elemAddr, hash))
+      return ix;
+  return -1;
+}
+
+/*
+ * Sizing
+ * ------
+ * grow_at caches the count above which the table grows, max_load times the
+ * number of buckets, so that hashset_enter does no floating point.
+ */
+
+static const double kMaxLoadChained   = 1.0;
+static const double kMaxLoadRobinHood = 0.9;
+
+static size_t grow_threshold(const hashset_t *h, size_t numBuckets) {
+  double at = h->max_load * (double) numBuckets;
+  size_t n = (at >= (double) SIZE_MAX) ? SIZE_MAX : (size_t) at;
+  if (h->engine == HASHSET_ROBIN_HOOD && n > numBuckets - 1)
+    n = numBuckets - 1;   // keep an empty slot, which ends every probe sequence
+  return n;
+}
+
+static void hashset_overflow(void) {
+  errno = ENOMEM;
+  perror("hashset_t size overflow");
+  exit(EXIT_FAILURE);
+}
+
+// the fewest buckets holding n elements within the maximum load factor
+static size_t buckets_for(const hashset_t *h, size_t n) {
+  double b = (double) n / h->max_load;
+  if (b >= (double) (SIZE_MAX / 2))
+    hashset_overflow();
+  size_t num = (b < 1.0) ? 1 : (size_t) b;
+  while (grow_threshold(h, num) < n)
+    num++;
+  return num;
+}
+
+// the least power of two not less than n
+static size_t next_pow2(size_t n) {
+  size_t p = 1;
+  while (p < n) {
+    if (p > SIZE_MAX / 2)
+      hashset_overflow();
+    p <<= 1;
+  }
+  return p;
+}
+
+static void hashset_resize(hashset_t *h, size_t numBuckets) {
+  if (h->hash64_fun != NULL)
+    numBuckets = next_pow2(numBuckets);
+  if (h->engine == HASHSET_ROBIN_HOOD)
+    rh_resize(h, numBuckets);
+  else
+    chained_resize(h, numBuckets);
+  h->grow_at = grow_threshold(h, h->num_buckets);
+}
+
+static void hashset_grow(hashset_t *h) {
+  // double, more than once if the maximum load is so low that the next
+  // enter would grow the table again
+  size_t numBuckets = h->num_buckets;
+  do {
+    if (numBuckets > SIZE_MAX / 2)
+      hashset_overflow();
+    numBuckets *= 2;
+  } while (grow_threshold(h, numBuckets) <= h->count);
+  if (h->incremental) {
+    chained_start_rehash(h, numBuckets);
+    h->grow_at = grow_threshold(h, h->num_buckets);
+    // every enter takes a step: spread the old buckets over the enters left
+    // before the next growth, each step visiting at least rehash_step buckets
+    size_t enters_left = (h->grow_at > h->count) ? h->grow_at - h->count : 1;
+    h->rehash_step = (h->old_num_buckets + enters_left - 1) / enters_left;
+  }
+  else
+    hashset_resize(h, numBuckets);
+}
+
+static void rh_enter(hashset_t *h, const void *elemAddr) {
+  uint64_t hash = hashset_hash(h, elemAddr);
+  ptrdiff_t ix = rh_find(h, elemAddr, hash);
+  if (ix != -1) {
+    if (h->free_fun != NULL)
+      h->free_fun(rh_slot(h, ix));
+    memcpy(rh_slot(h, ix), elemAddr, h->elem_size);
+    return;
+  }
+  if (h->count + 1 > h->grow_at)
+    hashset_grow(h);
+  // the entry is assembled in the swap area, rh_insert carries it in tmp
+  char *p_entry = (char *) h->tmp + h->entry_size;
+  memcpy(p_entry, elemAddr, h->elem_size);
+  *entry_hash(h, p_entry) = hash;
+  rh_insert(h, p_entry);
+  h->count++;
+}
+
+static void hashset_init(hashset_t *h, hashset_engine_t engine, size_t elemSize, size_t numBuckets,
+                         hashset_hash_fun_t hashfn,
+                         hashset_hash64_fun_t hash64fn,
+                         hashset_cmp_fun_t cmpfn,
+                         hashset_free_fun_t freefn,
+                         const allocator_t *alloc) {
   //
   assert(elemSize > 0 && numBuckets >0);
-  assert(hashfn != NULL && cmpfn != NULL);
+  assert((hashfn != NULL) != (hash64fn != NULL) && cmpfn != NULL);
   //
+  if (hash64fn != NULL)
+    numBuckets = next_pow2(numBuckets);
   h->hash_fun    = hashfn;
+  h->hash64_fun  = hash64fn;
   h->cmp_fun     = cmpfn;
   h->free_fun    = freefn;  
   h->count       = 0;
   h->num_buckets = numBuckets;
   h->elem_size   = elemSize;
+  h->hash_offset = (elemSize + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+  h->entry_size  = h->hash_offset + sizeof(uint64_t);
   h->chunk_size  = 4;        // how many element(s) to store in vector (initially)
+  h->alloc       = allocator_or_default(alloc);
+  h->engine      = engine;
+  h->slots       = NULL;
+  h->probe_len   = NULL;
+  h->tmp         = NULL;
+  h->incremental = false;
+  h->old_bucket_lst  = NULL;
+  h->old_num_buckets = 0;
+  h->rehash_pos      = 0;
+  h->rehash_step     = 0;
   //
-  // need to allocate room for h->num_buckets of type vector_t *
-  h->bucket_lst  = (vector_t *) calloc(h->num_buckets, sizeof(vector_t *)); 
-  if (h->bucket_lst == NULL) {
-    perror("could not allocate memory for the hashset_t");
-    exit(EXIT_FAILURE);
+  if (engine == HASHSET_ROBIN_HOOD) {
+    h->max_load   = kMaxLoadRobinHood;
+    h->bucket_lst = NULL;
+    rh_alloc_table(h, (numBuckets < 2) ? 2 : numBuckets);
   }
-  for(uint_t ix_bucket = 0; ix_bucket < h->num_buckets; ix_bucket++) {
-    vector_t *v = &h->bucket_lst[ix_bucket];
-    vector_new(v, h->elem_size, h->free_fun, h->chunk_size);
-    assert(v != NULL);
+  else {
+    assert(engine == HASHSET_CHAINED);
+    h->max_load   = kMaxLoadChained;
+    h->bucket_lst = chained_alloc_buckets(h, h->num_buckets);
   }
+  h->tmp     = rh_calloc(h, 2, h->entry_size);
+  h->grow_at = grow_threshold(h, h->num_buckets);
+}
+
+void hashset_new_engine(hashset_t *h, hashset_engine_t engine, size_t elemSize, size_t numBuckets,
+                        hashset_hash_fun_t hashfn,
+                        hashset_cmp_fun_t cmpfn,
+                        hashset_free_fun_t freefn,
+                        const allocator_t *alloc) {
+  assert(hashfn != NULL);
+  hashset_init(h, engine, elemSize, numBuckets, hashfn, NULL, cmpfn, freefn, alloc);
+}
+
+void hashset_new64(hashset_t *h, hashset_engine_t engine, size_t elemSize, size_t numBuckets,
+                   hashset_hash64_fun_t hashfn,
+                   hashset_cmp_fun_t cmpfn,
+                   hashset_free_fun_t freefn,
+                   const allocator_t *alloc) {
+  assert(hashfn != NULL);
+  hashset_init(h, engine, elemSize, numBuckets, NULL, hashfn, cmpfn, freefn, alloc);
 }
 
 void hashset_dispose(hashset_t *h) {
   assert(h != NULL);
-  for(uint_t ix_bucket = 0; ix_bucket < h->num_buckets; ix_bucket++) {
+  if (h->engine == HASHSET_ROBIN_HOOD) {
+    if (h->free_fun != NULL)
+      for (size_t k = 0; k < h->num_buckets; k++)
+        if (h->probe_len[k] != 0)
+          h->free_fun(rh_slot(h, k));
+    rh_free_table(h, h->slots, h->probe_len, h->num_buckets);
+    h->alloc->free(h->alloc->ctx, h->tmp, 2 * h->entry_size);
+    memset(h, 0, sizeof(hashset_t));
+    return;
+  }
+  h->alloc->free(h->alloc->ctx, h->tmp, 2 * h->entry_size);
+  if (h->old_bucket_lst != NULL) {
+    // the old buckets which have not moved yet
+    for(size_t ix_bucket = h->rehash_pos; ix_bucket < h->old_num_buckets; ix_bucket++)
+      vector_dispose(&h->old_bucket_lst[ix_bucket]);
+    chained_end_rehash(h);
+  }
+  for(size_t ix_bucket = 0; ix_bucket < h->num_buckets; ix_bucket++) {
     vector_dispose(&h->bucket_lst[ix_bucket]);
   }
   // free the bucket list (which is a dynamic array)
-  free(h->bucket_lst);
+  h->alloc->free(h->alloc->ctx, h->bucket_lst, h->num_buckets * sizeof(vector_t));
   h->bucket_lst = NULL;
   // then clear the hashset_t struct
   memset(h, 0, sizeof(hashset_t));
 }
 
-uint_t hashset_count(const hashset_t *h) { 
+size_t hashset_count(const hashset_t *h) { 
   return h->count; 
 }
 
+void hashset_set_max_load(hashset_t *h, double maxLoad) {
+  assert(maxLoad > 0.0);
+  assert(h->engine != HASHSET_ROBIN_HOOD || maxLoad < 1.0);
+  chained_finish_rehash(h);
+  h->max_load = maxLoad;
+  h->grow_at  = grow_threshold(h, h->num_buckets);
+  if (h->count > h->grow_at)
+    hashset_resize(h, buckets_for(h, h->count));
+}
+
+void hashset_reserve(hashset_t *h, size_t n) {
+  chained_finish_rehash(h);
+  size_t num = buckets_for(h, n);
+  if (num > h->num_buckets)
+    hashset_resize(h, num);
+}
+
+void hashset_rehash(hashset_t *h, size_t numBuckets) {
+  assert(numBuckets > 0);
+  size_t num = buckets_for(h, h->count);
+  hashset_resize(h, (numBuckets > num) ? numBuckets : num);
+}
+
+void hashset_set_incremental(hashset_t *h, bool incremental) {
+  assert(h->engine == HASHSET_CHAINED);
+  h->incremental = incremental;
+  if (!incremental)
+    chained_finish_rehash(h);
+}
+
+bool hashset_rehashing(const hashset_t *h) {
+  return h->old_bucket_lst != NULL;
+}
+
 void hashset_enter(hashset_t *h, const void *elemAddr) {
   // (1) check
   assert(elemAddr != NULL);
+  if (h->engine == HASHSET_ROBIN_HOOD) {
+    rh_enter(h, elemAddr);
+    return;
+  }
+  chained_rehash_step(h);
   //
-  // (2) compute the hash key == bucket_num
-  int bucket_num = h->hash_fun(elemAddr, h->num_buckets);
-  assert(bucket_num >= 0 && bucket_num < h->num_buckets);
-  //
-  // (3) 2 cases: h->bucket_lst[bucket_num] == NULL || h->bucket_lst[bucket_num]  defined
-  vector_t *v = &h->bucket_lst[bucket_num];  
-  /**
-  if (v == NULL) {
-    // initialize a vector_t
-    vector_new(v, h->elem_size, h->free_fun, h->chunk_size);
-    assert(v != NULL);
-  }
-  */
+  // (2) find the bucket from the hash key
+  uint64_t hash = hashset_hash(h, elemAddr);
+  vector_t *v = chained_bucket(h, hash);
   //
-  // (4) lookup elemAddr in this vector
-  int ix = vector_search(v, elemAddr, h->cmp_fun, 0, false);
+  // (3) lookup elemAddr in this vector
+  ptrdiff_t ix = chained_find(h, v, elemAddr, hash);
   //
   // 
   if (ix == -1) {
-    vector_append(v, elemAddr);
+    memcpy(h->tmp, elemAddr, h->elem_size);
+    *entry_hash(h, h->tmp) = hash;
+    vector_append(v, h->tmp);
     h->count++;
+    if (h->count > h->grow_at)
+      hashset_grow(h);
   }
   else {
-    // free that position and ...
-    vector_delete(v, ix); 
-    // ... do the insert
-    vector_insert(v, elemAddr, ix);
+    // free the element in place and overwrite it (same hash code),
     // which means that h->count remains the same
+    void *p_entry = vector_nth(v, ix);
+    if (h->free_fun != NULL)
+      h->free_fun(p_entry);
+    memcpy(p_entry, elemAddr, h->elem_size);
   }
 }
 
 void *hashset_lookup(const hashset_t *h, const void *elemAddr) { 
   // (1) check
   assert(elemAddr != NULL);
+  uint64_t hash = hashset_hash(h, elemAddr);
+  if (h->engine == HASHSET_ROBIN_HOOD) {
+    ptrdiff_t ix = rh_find(h, elemAddr, hash);
+    return (ix == -1) ? NULL : rh_slot(h, ix);
+  }
+  // a lookup moves a few buckets too: the elements stay the same, only
+  // where they are stored changes
+  chained_rehash_step((hashset_t *) h);
   //
-  // (2) compute the hash key == bucket_num
-  int bucket_num = h->hash_fun(elemAddr, h->num_buckets);
-  assert(bucket_num >= 0 && bucket_num < h->num_buckets);  
-  //
-  // (3)
-  vector_t *v = &h->bucket_lst[bucket_num];  
-  if (v == NULL) 
-    return v;
-  //
-  // now v != NULL
-  int ix = vector_search(v, elemAddr, h->cmp_fun, 0, false);
+  // (2) find the bucket from the hash key
+  vector_t *v = chained_bucket(h, hash);
+  ptrdiff_t ix = chained_find(h, v, elemAddr, hash);
   if (ix == -1) {
     return NULL;
   }
@@ -112,8 +539,126 @@ void hashset_map(hashset_t *h, hashset_map_fun_t mapfn, void *auxData) {
   assert(mapfn != NULL);
   //
   // (2)
-  for(uint_t ix_bucket = 0; ix_bucket < h->num_buckets; ix_bucket++) {
+  if (h->engine == HASHSET_ROBIN_HOOD) {
+    for (size_t k = 0; k < h->num_buckets; k++)
+      if (h->probe_len[k] != 0)
+        mapfn(rh_slot(h, k), auxData);
+    return;
+  }
+  if (h->old_bucket_lst != NULL)
+    for(size_t ix_bucket = h->rehash_pos; ix_bucket < h->old_num_buckets; ix_bucket++)
+      vector_map(&h->old_bucket_lst[ix_bucket], mapfn, auxData);
+  for(size_t ix_bucket = 0; ix_bucket < h->num_buckets; ix_bucket++) {
     vector_map(&h->bucket_lst[ix_bucket], mapfn, auxData); 
   }
 }
 
+
+/*
+ * Built-in hashers
+ * ----------------
+ * In the manner of wyhash: the input is read 8 (or 4) bytes at a time and
+ * folded with a 64x64->128 bit multiplication whose two halves are xored
+ * (hash_mix), which mixes every input bit into every output bit.  The reads
+ * go through memcpy, so the input needs no alignment, and the codes depend on
+ * the byte order of the machine.
+ */
+
+static const uint64_t kHashSecret[4] = {
+  0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+static inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = (__uint128_t) a * b;
+  return (uint64_t) r ^ (uint64_t) (r >> 64);
+#else
+  uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t) a, lb = (uint32_t) b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  return lo ^ hi;
+#endif
+}
+
+static inline uint64_t read64(const unsigned char *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t read32(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint64_t hashset_hash_bytes(const void *data, size_t len, uint64_t seed) {
+  const unsigned char *p = data;
+  uint64_t a, b;
+  seed ^= hash_mix(seed ^ kHashSecret[0], kHashSecret[1]);
+  if (len <= 16) {
+    if (len >= 4) {
+      // two overlapping pairs of 4-byte reads cover 4 to 16 bytes
+      size_t mid = (len >> 3) << 2;
+      a = (read32(p) << 32) | read32(p + mid);
+      b = (read32(p + len - 4) << 32) | read32(p + len - 4 - mid);
+    }
+    else if (len > 0) {
+      a = ((uint64_t) p[0] << 16) | ((uint64_t) p[len >> 1] << 8) | p[len - 1];
+      b = 0;
+    }
+    else
+      a = b = 0;
+  }
+  else {
+    size_t i = len;
+    if (i > 48) {
+      // three independent lanes of 16 bytes
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = hash_mix(read64(p) ^ kHashSecret[1], read64(p + 8) ^ seed);
+        see1 = hash_mix(read64(p + 16) ^ kHashSecret[2], read64(p + 24) ^ see1);
+        see2 = hash_mix(read64(p + 32) ^ kHashSecret[3], read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = hash_mix(read64(p) ^ kHashSecret[1], read64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    // the last 16 bytes, overlapping the ones already mixed if need be
+    a = read64(p + i - 16);
+    b = read64(p + i - 8);
+  }
+  return hash_mix(kHashSecret[1] ^ (uint64_t) len, hash_mix(a ^ kHashSecret[1], b ^ seed));
+}
+
+uint64_t hashset_hash_str(const char *s) {
+  return hashset_hash_bytes(s, strlen(s), 0);
+}
+
+uint64_t hashset_hash_u64(uint64_t key) {
+  return hash_mix(hash_mix(key ^ kHashSecret[0], kHashSecret[1]) ^ key, kHashSecret[2]);
+}
+
+uint64_t hashset_hash_str_elem(const void *elemAddr) {
+  return hashset_hash_str(*(const char * const *) elemAddr);
+}
+
+uint64_t hashset_hash_u32_elem(const void *elemAddr) {
+  uint32_t key;
+  memcpy(&key, elemAddr, sizeof(key));
+  return hashset_hash_u64(key);
+}
+
+uint64_t hashset_hash_u64_elem(const void *elemAddr) {
+  uint64_t key;
+  memcpy(&key, elemAddr, sizeof(key));
+  return hashset_hash_u64(key);
+}
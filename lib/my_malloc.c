@@ -1,4 +1,5 @@
 #include "my_malloc.h"
+#include <string.h>
 
 
 void *xmalloc(size_t sz) {
@@ -26,3 +27,46 @@ void *xmalloc0(size_t sz) {
     return ptr;
   }
 }
+
+
+// the default allocator, on top of the C library
+static void *std_alloc(void *ctx, size_t sz) {
+  return malloc(sz);
+}
+
+static void *std_realloc(void *ctx, void *ptr, size_t old_sz, size_t new_sz) {
+  return realloc(ptr, new_sz);
+}
+
+static void std_free(void *ctx, void *ptr, size_t sz) {
+  free(ptr);
+}
+
+const allocator_t default_allocator = { std_alloc, std_realloc, std_free, NULL };
+
+
+void *xalloc(const allocator_t *alloc, size_t sz) {
+  alloc = allocator_or_default(alloc);
+  void *ptr = alloc->alloc(alloc->ctx, sz);
+
+  if (!ptr) {
+    perror("xalloc");
+    exit(EXIT_FAILURE);
+  }
+  return ptr;
+}
+
+
+void *xalloc0(const allocator_t *alloc, size_t sz) {
+  void *ptr = xalloc(alloc, sz);
+
+  memset(ptr, 0, sz);
+  return ptr;
+}
+
+
+void xfree(const allocator_t *alloc, void *ptr, size_t sz) {
+  alloc = allocator_or_default(alloc);
+  if (ptr != NULL)
+    alloc->free(alloc->ctx, ptr, sz);
+}
@@ -0,0 +1,214 @@
+#include "pqueue.h"
+#include "my_malloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// end of the list of free handles
+static const size_t kNoSlot = (size_t) -1;
+
+void pqueue_new(pqueue_t *pq, size_t elemSize, pqueue_cmp_fun_t cmp_fun, pqueue_free_fun_t free_fun, uint_t arity) {
+  //
+  assert(elemSize > 0 && cmp_fun != NULL);
+  assert(arity == 2 || arity == 4);
+  //
+  pq->cmp_fun   = cmp_fun;
+  pq->free_fun  = free_fun;
+  pq->arity     = arity;
+  pq->free_slot = kNoSlot;
+  pq->tmp       = xmalloc(elemSize);
+  vector_new(&pq->heap, elemSize, NULL, 0);
+  vector_new(&pq->handles, sizeof(size_t), NULL, 0);
+  vector_new(&pq->slots, sizeof(size_t), NULL, 0);
+}
+
+size_t pqueue_len(const pqueue_t *pq) {
+  return vector_len(&pq->heap);
+}
+
+/*
+ * Heap moves
+ * ----------
+ * The element being sifted is kept in pq->tmp while the ones it passes over
+ * move into the hole, one memcpy each instead of a three-way swap; every
+ * move updates the slot of the moved element's handle.
+ */
+static inline char *heap_at(const pqueue_t *pq, size_t pos) {
+  return (char *) vector_data(&pq->heap) + pos * pq->heap.elem_size;
+}
+
+static inline size_t *handle_at(const pqueue_t *pq, size_t pos) {
+  return (size_t *) vector_data(&pq->handles) + pos;
+}
+
+static inline size_t *slot_at(const pqueue_t *pq, pqueue_handle_t handle) {
+  return (size_t *) vector_data(&pq->slots) + handle;
+}
+
+static inline void heap_move(pqueue_t *pq, size_t from, size_t to) {
+  memcpy(heap_at(pq, to), heap_at(pq, from), pq->heap.elem_size);
+  *handle_at(pq, to) = *handle_at(pq, from);
+  *slot_at(pq, *handle_at(pq, to)) = to;
+}
+
+static inline void heap_place(pqueue_t *pq, size_t pos, size_t handle) {
+  memcpy(heap_at(pq, pos), pq->tmp, pq->heap.elem_size);
+  *handle_at(pq, pos) = handle;
+  *slot_at(pq, handle) = pos;
+}
+
+void pqueue_dispose(pqueue_t *pq) {
+  if (pq->free_fun != NULL)
+    for (size_t pos = 0; pos < pqueue_len(pq); pos++)
+      pq->free_fun(heap_at(pq, pos));
+  vector_dispose(&pq->heap);
+  vector_dispose(&pq->handles);
+  vector_dispose(&pq->slots);
+  free(pq->tmp);
+  memset(pq, 0, sizeof(pqueue_t));
+}
+
+// returns the final position of the element
+static size_t sift_up(pqueue_t *pq, size_t pos) {
+  size_t handle = *handle_at(pq, pos);
+  memcpy(pq->tmp, heap_at(pq, pos), pq->heap.elem_size);
+  while (pos > 0) {
+    size_t parent = (pos - 1) / pq->arity;
+    if (pq->cmp_fun(pq->tmp, heap_at(pq, parent)) >= 0)
+      break;
+    heap_move(pq, parent, pos);
+    pos = parent;
+  }
+  heap_place(pq, pos, handle);
+  return pos;
+}
+
+static void sift_down(pqueue_t *pq, size_t pos) {
+  size_t n = pqueue_len(pq), handle = *handle_at(pq, pos);
+  memcpy(pq->tmp, heap_at(pq, pos), pq->heap.elem_size);
+  for (;;) {
+    size_t first = pos * pq->arity + 1;
+    if (first >= n)
+      break;
+    size_t last = (n - first > pq->arity) ? first + pq->arity : n;
+    size_t least = first;
+    for (size_t child = first + 1; child < last; child++)
+      if (pq->cmp_fun(heap_at(pq, child), heap_at(pq, least)) < 0)
+        least = child;
+    if (pq->cmp_fun(heap_at(pq, least), pq->tmp) >= 0)
+      break;
+    heap_move(pq, least, pos);
+    pos = least;
+  }
+  heap_place(pq, pos, handle);
+}
+
+// a free handle, or a new one
+static pqueue_handle_t handle_alloc(pqueue_t *pq) {
+  pqueue_handle_t handle = pq->free_slot;
+  if (handle != kNoSlot) {
+    pq->free_slot = *slot_at(pq, handle);
+    return handle;
+  }
+  handle = vector_len(&pq->slots);
+  vector_append(&pq->slots, &handle);
+  return handle;
+}
+
+static void handle_release(pqueue_t *pq, pqueue_handle_t handle) {
+  *slot_at(pq, handle) = pq->free_slot;
+  pq->free_slot = handle;
+}
+
+pqueue_handle_t pqueue_push(pqueue_t *pq, const void *elemAddr) {
+  assert(elemAddr != NULL);
+  pqueue_handle_t handle = handle_alloc(pq);
+  size_t pos = pqueue_len(pq);
+  vector_append(&pq->heap, elemAddr);
+  vector_append(&pq->handles, &handle);
+  *slot_at(pq, handle) = pos;
+  sift_up(pq, pos);
+  return handle;
+}
+
+void *pqueue_peek(const pqueue_t *pq) {
+  return (pqueue_len(pq) == 0) ? NULL : heap_at(pq, 0);
+}
+
+void pqueue_pop(pqueue_t *pq, void *elemAddr) {
+  assert(pqueue_len(pq) > 0);
+  //
+  if (elemAddr != NULL)
+    memcpy(elemAddr, heap_at(pq, 0), pq->heap.elem_size);
+  else if (pq->free_fun != NULL)
+    pq->free_fun(heap_at(pq, 0));
+  handle_release(pq, *handle_at(pq, 0));
+  // the last element fills the hole at the top, then sinks
+  size_t last = pqueue_len(pq) - 1;
+  if (last > 0)
+    heap_move(pq, last, 0);
+  vector_delete(&pq->heap, last);
+  vector_delete(&pq->handles, last);
+  if (last > 1)
+    sift_down(pq, 0);
+  return;
+}
+
+void pqueue_heapify(pqueue_t *pq, const vector_t *v) {
+  assert(v->elem_size == pq->heap.elem_size);
+  //
+  size_t n = vector_len(v);
+  if (n == 0)
+    return;
+  size_t start = pqueue_len(pq);
+  if (start == 0) {
+    // no handle in use: forget the free ones, so that handles are 0..n-1
+    vector_erase_range(&pq->slots, 0, vector_len(&pq->slots));
+    pq->free_slot = kNoSlot;
+  }
+  vector_append_n(&pq->heap, vector_data(v), n);
+  vector_reserve(&pq->handles, start + n);
+  for (size_t pos = start; pos < start + n; pos++) {
+    pqueue_handle_t handle = handle_alloc(pq);
+    vector_append(&pq->handles, &handle);
+    *slot_at(pq, handle) = pos;
+  }
+  // Floyd's construction: sift down every inner node, the deepest first
+  size_t len = start + n;
+  if (len > 1)
+    for (size_t pos = (len - 2) / pq->arity + 1; pos > 0; pos--)
+      sift_down(pq, pos - 1);
+  return;
+}
+
+bool pqueue_contains(const pqueue_t *pq, pqueue_handle_t handle) {
+  // a free handle is at no position of the heap, whatever its slot holds
+  if (handle >= vector_len(&pq->slots))
+    return false;
+  size_t pos = *slot_at(pq, handle);
+  return pos < pqueue_len(pq) && *handle_at(pq, pos) == handle;
+}
+
+void *pqueue_get(const pqueue_t *pq, pqueue_handle_t handle) {
+  assert(pqueue_contains(pq, handle));
+  return heap_at(pq, *slot_at(pq, handle));
+}
+
+void pqueue_decrease_key(pqueue_t *pq, pqueue_handle_t handle, const void *elemAddr) {
+  assert(pqueue_contains(pq, handle) && elemAddr != NULL);
+  size_t pos = *slot_at(pq, handle);
+  assert(pq->cmp_fun(elemAddr, heap_at(pq, pos)) <= 0);
+  memcpy(heap_at(pq, pos), elemAddr, pq->heap.elem_size);
+  sift_up(pq, pos);
+  return;
+}
+
+void pqueue_update(pqueue_t *pq, pqueue_handle_t handle, const void *elemAddr) {
+  assert(pqueue_contains(pq, handle) && elemAddr != NULL);
+  size_t pos = *slot_at(pq, handle);
+  memcpy(heap_at(pq, pos), elemAddr, pq->heap.elem_size);
+  if (sift_up(pq, pos) == pos)
+    sift_down(pq, pos);
+  return;
+}
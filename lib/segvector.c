@@ -0,0 +1,131 @@
+#include "segvector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdint.h>
+#include <errno.h>
+
+static const size_t kDefaultSegmentSize = 16;
+
+// position of the highest bit set in n (n > 0)
+static inline uint_t floor_log2(uint64_t n) {
+#if defined(__GNUC__)
+  return 63 - __builtin_clzll(n);
+#else
+  uint_t k = 0;
+  while (n >>= 1)
+    k++;
+  return k;
+#endif
+}
+
+/*
+ * Segment k holds B << k elements (B = 1 << base_shift) and starts at position
+ * B * (2^k - 1), so position i lives in segment floor_log2(i / B + 1).
+ */
+static inline uint_t segment_of(const segvector_t *sv, size_t position, size_t *offset) {
+  uint_t k = floor_log2(((uint64_t) position >> sv->base_shift) + 1);
+  *offset = position - ((((size_t) 1 << k) - 1) << sv->base_shift);
+  return k;
+}
+
+// the next segment would not be addressable: same failure as vector_t
+static void segvector_overflow(segvector_t *sv) {
+  segvector_dispose(sv);
+  errno = ENOMEM;
+  perror("segvector size overflow");
+  exit(EXIT_FAILURE);
+}
+
+void segvector_new(segvector_t *sv, size_t elemSize, vector_free_fun_t free_fun, size_t initAlloc) {
+  //
+  assert(elemSize > 0);
+  assert(initAlloc <= (size_t) 1 << (SEGVECTOR_MAX_SEGMENTS - 1));
+  //
+  if (initAlloc == 0)
+    initAlloc = kDefaultSegmentSize;
+  sv->free_fun     = free_fun;
+  sv->size         = 0;
+  sv->elem_size    = elemSize;
+  sv->base_shift   = floor_log2(initAlloc);
+  if (((size_t) 1 << sv->base_shift) < initAlloc)   // round up to a power of two
+    sv->base_shift++;
+  sv->num_segments = 0;
+  memset(sv->segments, 0, sizeof(sv->segments));
+}
+
+void segvector_dispose(segvector_t *sv) {
+  if (sv->free_fun != NULL)
+    for (size_t pos = 0; pos < sv->size; pos++)
+      sv->free_fun(segvector_nth(sv, pos));
+  for (uint_t k = 0; k < sv->num_segments; k++)
+    free(sv->segments[k]);
+  memset(sv, 0, sizeof(segvector_t));
+}
+
+size_t segvector_len(const segvector_t *sv) {
+  return sv->size;
+}
+
+void *segvector_nth(const segvector_t *sv, size_t position) {
+  assert(position < sv->size);
+  size_t offset;
+  uint_t k = segment_of(sv, position, &offset);
+  return (char *) sv->segments[k] + offset * sv->elem_size;
+}
+
+void *segvector_append(segvector_t *sv, const void *elemAddr) {
+  assert(elemAddr != NULL);
+  //
+  size_t offset;
+  if (sv->size == SIZE_MAX)
+    segvector_overflow(sv);
+  uint_t k = segment_of(sv, sv->size, &offset);
+  if (k == sv->num_segments) {
+    // all segments are full: add the next one, nothing moves
+    if (sv->base_shift + k >= SEGVECTOR_MAX_SEGMENTS)
+      segvector_overflow(sv);
+    size_t seg_len = (size_t) 1 << (sv->base_shift + k);
+    if (seg_len > SIZE_MAX / sv->elem_size)
+      segvector_overflow(sv);
+    void *segment = malloc(seg_len * sv->elem_size);
+    if (segment == NULL) {
+      perror("could not allocate space for the segvector segment");
+      segvector_dispose(sv);
+      exit(EXIT_FAILURE);
+    }
+    sv->segments[sv->num_segments++] = segment;
+  }
+  void *ptr = (char *) sv->segments[k] + offset * sv->elem_size;
+  memcpy(ptr, elemAddr, sv->elem_size);
+  sv->size++;
+  return ptr;
+}
+
+void segvector_replace(segvector_t *sv, const void *elemAddr, size_t position) {
+  void *ptr = segvector_nth(sv, position);
+  if (sv->free_fun != NULL)
+    sv->free_fun(ptr);
+  memcpy(ptr, elemAddr, sv->elem_size);
+}
+
+void segvector_pop(segvector_t *sv) {
+  assert(sv->size > 0);
+  if (sv->free_fun != NULL)
+    sv->free_fun(segvector_nth(sv, sv->size - 1));
+  sv->size--;
+}
+
+void segvector_map(segvector_t *sv, vector_map_fun_t map_fun, void *auxData) {
+  assert(map_fun != NULL);
+  //
+  // walk segment by segment, no index computation per element
+  size_t pos = 0;
+  for (uint_t k = 0; k < sv->num_segments && pos < sv->size; k++) {
+    char *p = sv->segments[k];
+    size_t seg_len = (size_t) 1 << (sv->base_shift + k);
+    for (size_t n = 0; n < seg_len && pos < sv->size; n++, pos++, p += sv->elem_size)
+      map_fun(p, auxData);
+  }
+}
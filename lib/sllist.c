@@ -15,15 +15,23 @@ int list_new(sllist_t **lst,
              int (*match)(const void *k1, const void *k2), 
              void (*destroy)(void *data),
              void (*cb)(const void *data)) {
+  return list_new_with(lst, match, destroy, cb, NULL);
+}
+
+int list_new_with(sllist_t **lst, 
+                  int (*match)(const void *k1, const void *k2), 
+                  void (*destroy)(void *data),
+                  void (*cb)(const void *data),
+                  const allocator_t *alloc) {
   /*
    *lst = (sllist_t *) malloc(sizeof(sllist_t));
 
    if (*lst == NULL)
      return -1;    // fail to allocate space for the new list
   */
-  *lst = xmalloc0(sizeof(sllist_t));
+  *lst = xalloc0(alloc, sizeof(sllist_t));
 
-  list_init(*lst, match, destroy, cb);
+  list_init_with(*lst, match, destroy, cb, alloc);
   return 0;
 }
 
@@ -31,32 +39,47 @@ void list_init(sllist_t *lst,
                int (*match)(const void *k1, const void *k2), 
                void (*destroy)(void *data),
                void (*cb)(const void *data)) {
+  list_init_with(lst, match, destroy, cb, NULL);
+}
+
+void list_init_with(sllist_t *lst, 
+                    int (*match)(const void *k1, const void *k2), 
+                    void (*destroy)(void *data),
+                    void (*cb)(const void *data),
+                    const allocator_t *alloc) {
   lst->size    = 0;
   lst->match   = match;
   lst->destroy = destroy;
   lst->cb      = cb;
   lst->head    = lst->tail = NULL;
+  lst->alloc   = allocator_or_default(alloc);
 }
 
-void list_free(sllist_t **lst) {
+void list_clear(sllist_t *lst) {
   void *data;
 
-  while ((*lst)->size > 0) {
-    if (list_rem_next(*lst, NULL, (void **) &data) == 0 && 
-        (*lst)->destroy != NULL) {
-      (*lst)->destroy(data);
+  while (lst->size > 0) {
+    if (list_rem_next(lst, NULL, (void **) &data) == 0 && 
+        lst->destroy != NULL) {
+      lst->destroy(data);
     }
   }
+}
+
+void list_free(sllist_t **lst) {
+  const allocator_t *alloc = (*lst)->alloc;
+
+  list_clear(*lst);
   //
   memset(*lst, 0, sizeof(sllist_t));
-  free(*lst);
+  xfree(alloc, *lst, sizeof(sllist_t));
   *lst = NULL;
   return;
 }
 
 int list_ins_next(sllist_t *lst, sllistItm_t *itm, const void *data) {
   //sllistItm_t *plitm = (sllistItm_t *) malloc(sizeof(sllistItm_t));
-  sllistItm_t *plitm = xmalloc0(sizeof(sllistItm_t));
+  sllistItm_t *plitm = xalloc0(lst->alloc, sizeof(sllistItm_t));
 
   // test that allocation was successful, if not return -1
   if (plitm == NULL) return -1;
@@ -112,7 +135,7 @@ int list_rem_next(sllist_t *lst, sllistItm_t *itm, void **data) {
 
   // Free the storage allocated by the abstract datatype
   memset(pitm, 0, sizeof(sllistItm_t));
-  free(pitm);
+  xfree(lst->alloc, pitm, sizeof(sllistItm_t));
 
   // Adjust the size of the list to account for the removed element
   lst->size--;
@@ -130,21 +153,20 @@ int list_rem(sllist_t *lst, void **data) {
   if (pitm == NULL) 
     return -1;     // *data is not in the list lst
 
-  if (pitm == list_head(lst))
+  if (pitm == list_head(lst)) {
     lst->head = pitm->next;   // Handle removal from the head of the list.
+    if (lst->head == NULL) lst->tail = NULL;
+  }
   else {
     ppitm->next = pitm->next;
     if (pitm == list_tail(lst)) 
       lst->tail = ppitm;     // Handle removal from the tail of the list.
   }
   
-  /*
-  if (lst->destroy != NULL)
-    lst->destroy(data);
-
+  // the data goes back to the caller, only the item is freed
+  *data = pitm->data;
   memset(pitm, 0, sizeof(sllistItm_t));
-  free(pitm);
-  */
+  xfree(lst->alloc, pitm, sizeof(sllistItm_t));
 
   --lst->size;
   return 0;
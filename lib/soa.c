@@ -0,0 +1,72 @@
+#include "soa.h"
+#include "my_malloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+void soa_new(soa_t *s, const soa_column_t *columns, size_t numColumns, size_t rowSize, size_t initAlloc) {
+  //
+  assert(columns != NULL && numColumns > 0);
+  for (size_t k = 0; k < numColumns; k++)
+    assert(columns[k].size > 0 && columns[k].offset <= rowSize &&
+           columns[k].size <= rowSize - columns[k].offset);
+  //
+  s->num_columns = numColumns;
+  s->row_size    = rowSize;
+  s->columns     = xmalloc(numColumns * sizeof(soa_column_t));
+  s->data        = xmalloc(numColumns * sizeof(vector_t));
+  memcpy(s->columns, columns, numColumns * sizeof(soa_column_t));
+  for (size_t k = 0; k < numColumns; k++)
+    vector_new(&s->data[k], columns[k].size, NULL, initAlloc);
+}
+
+void soa_dispose(soa_t *s) {
+  for (size_t k = 0; k < s->num_columns; k++)
+    vector_dispose(&s->data[k]);
+  free(s->data);
+  free(s->columns);
+  memset(s, 0, sizeof(soa_t));
+}
+
+size_t soa_len(const soa_t *s) {
+  // all the columns have the same length
+  return vector_len(&s->data[0]);
+}
+
+void soa_reserve(soa_t *s, size_t n) {
+  for (size_t k = 0; k < s->num_columns; k++)
+    vector_reserve(&s->data[k], n);
+}
+
+void soa_append(soa_t *s, const void *rowAddr) {
+  assert(rowAddr != NULL);
+  for (size_t k = 0; k < s->num_columns; k++)
+    vector_append(&s->data[k], (const char *) rowAddr + s->columns[k].offset);
+}
+
+void soa_get_row(const soa_t *s, size_t position, void *rowAddr) {
+  assert(position < soa_len(s) && rowAddr != NULL);
+  for (size_t k = 0; k < s->num_columns; k++)
+    memcpy((char *) rowAddr + s->columns[k].offset,
+           vector_nth(&s->data[k], position),
+           s->columns[k].size);
+}
+
+void soa_set_row(soa_t *s, size_t position, const void *rowAddr) {
+  assert(position < soa_len(s) && rowAddr != NULL);
+  for (size_t k = 0; k < s->num_columns; k++)
+    memcpy(vector_nth(&s->data[k], position),
+           (const char *) rowAddr + s->columns[k].offset,
+           s->columns[k].size);
+}
+
+void *soa_column(const soa_t *s, size_t column) {
+  assert(column < s->num_columns);
+  return vector_data(&s->data[column]);
+}
+
+void *soa_nth(const soa_t *s, size_t column, size_t position) {
+  assert(column < s->num_columns);
+  return vector_nth(&s->data[column], position);
+}
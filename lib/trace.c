@@ -0,0 +1,67 @@
+#include "trace.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+static const char *kLevelNames[] = { "none", "error", "warn", "info", "debug" };
+
+static FILE *trace_fp      = NULL;
+static int   trace_fp_set  = 0;      // 0 until trace_output was called once
+
+// the ring buffer: next is the slot of the next message, count the number of
+// valid messages (<= TRACE_RING_SIZE)
+static char  ring[TRACE_RING_SIZE][TRACE_MSG_MAX];
+static int   ring_enabled  = 0;
+static unsigned int ring_next  = 0;
+static unsigned int ring_count = 0;
+
+void trace_emit(int level, const char *file, int line, const char *func,
+                const char *fmt, ...) {
+  char msg[TRACE_MSG_MAX];
+  va_list ap;
+  int len;
+  FILE *fp = trace_fp_set ? trace_fp : stderr;
+
+  if (fp == NULL && !ring_enabled)
+    return;
+  if (level < TRACE_LVL_ERROR || level > TRACE_LVL_DEBUG)
+    level = TRACE_LVL_NONE;
+
+  len = snprintf(msg, sizeof(msg), "[%s] %s:%d %s: ", kLevelNames[level], file, line, func);
+  if (len < 0)
+    return;
+  if ((size_t) len < sizeof(msg)) {
+    va_start(ap, fmt);
+    vsnprintf(msg + len, sizeof(msg) - len, fmt, ap);
+    va_end(ap);
+  }
+
+  if (ring_enabled) {
+    memcpy(ring[ring_next], msg, sizeof(msg));
+    ring_next = (ring_next + 1) % TRACE_RING_SIZE;
+    if (ring_count < TRACE_RING_SIZE)
+      ring_count++;
+  }
+  if (fp != NULL)
+    fprintf(fp, "%s\n", msg);
+}
+
+void trace_output(FILE *fp) {
+  trace_fp     = fp;
+  trace_fp_set = 1;
+}
+
+void trace_ring_enable(int enable) {
+  ring_enabled = (enable != 0);
+  if (ring_enabled)
+    ring_next = ring_count = 0;
+}
+
+int trace_dump(FILE *fp) {
+  unsigned int first = (ring_next + TRACE_RING_SIZE - ring_count) % TRACE_RING_SIZE;
+
+  for (unsigned int k = 0; k < ring_count; k++)
+    fprintf(fp, "%s\n", ring[(first + k) % TRACE_RING_SIZE]);
+  fflush(fp);
+  return (int) ring_count;
+}
@@ -1,18 +1,55 @@
+#define _POSIX_C_SOURCE 200809L   // for sysconf, mmap, ... with -std=c99
+
 #include "vector.h"
+#include "trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const size_t kDefaultChunkSize = 8;
+
+// upper bound on the number of threads used by the *_parallel functions
+static const uint_t kMaxWorkers = 64;
+
+// vector_t flags
+static const uint_t kMapped       = 0x1;   // headptr points into a file mapping
+static const uint_t kMappedShared = 0x2;   // ... which is written back to the file
 
-void vector_new(vector_t *v, uint_t elemSize, vector_free_fun_t free_fun, uint_t initAlloc) {
+static void vector_release(vector_t *v);
+
+// a size computation (n elements, or n * elem_size bytes) does not fit in a
+// size_t: fail as an allocation failure would, rather than wrap around
+static void vector_overflow(void) {
+  errno = ENOMEM;
+  perror("vector size overflow");
+  exit(EXIT_FAILURE);
+}
+
+void vector_new(vector_t *v, size_t elemSize, vector_free_fun_t free_fun, size_t initAlloc) {
+  vector_new_with(v, elemSize, free_fun, initAlloc, NULL);
+}
+
+void vector_new_with(vector_t *v, size_t elemSize, vector_free_fun_t free_fun, size_t initAlloc,
+                     const allocator_t *alloc) {
   //
-  assert(initAlloc > 0 && elemSize > 0);
+  assert(elemSize > 0);
   //
   v->size       = 0;
   v->free_fun   = free_fun;
-  v->chunk_size = initAlloc;
-  v->chunk_num  = 0;
+  v->alloc      = allocator_or_default(alloc);
+  v->chunk_size = (initAlloc > 0) ? initAlloc : kDefaultChunkSize;
+  v->capacity   = VECTOR_INLINE_BYTES / elemSize;   // the small buffer, maybe 0
   v->elem_size  = elemSize; 
+  v->flags      = 0;
   v->headptr    = NULL;
 }
  
@@ -21,37 +58,37 @@ void vector_dispose(vector_t *v) {
   // dispose of each element by calling the supplied free_fun (if it is not NULL)
   //  
   if (v->free_fun != NULL) {
-    for (uint_t pos = vector_len(v) - 1; pos > 0; pos--) {
-      void *elem_addr = vector_nth(v, pos);
+    for (size_t pos = vector_len(v); pos > 0; pos--) {
+      void *elem_addr = vector_nth(v, pos - 1);
       if (elem_addr != NULL) {
-        printf(">>> call free fun\n");
+        TRACE_DEBUG("call free fun on element %zu", pos - 1);
         v->free_fun(elem_addr);
       }
     }
     v->size = 0;
   }
   else {
-    printf(">>> nothing to do as free function was NULL\n");
-  } 
+    TRACE_DEBUG("nothing to do as free function was NULL");
+  }
   //  
-  // then de-allocate the chunks
-  free(v->headptr);
+  // then de-allocate (or unmap) the chunks
+  vector_release(v);
   v->headptr = NULL;
   //
   // then clear the vector_t struct
   memset(v, 0, sizeof(vector_t));
 }
 
-uint_t vector_len(const vector_t *v) { 
+size_t vector_len(const vector_t *v) { 
   return v->size; 
 }
 
-void *vector_nth(const vector_t *v, uint_t position) {
+void *vector_nth(const vector_t *v, size_t position) {
   assert(position < v->size);
-  return (char *) v->headptr + position * v->elem_size; 
+  return (char *) vector_data(v) + position * v->elem_size; 
 }
 
-void vector_replace(vector_t *v, const void *elemAddr, uint_t position) {
+void vector_replace(vector_t *v, const void *elemAddr, size_t position) {
   assert(position < vector_len(v));
   void *p_curr = vector_nth(v, position);
   if (v->free_fun != NULL)
@@ -62,133 +99,243 @@ void vector_replace(vector_t *v, const void *elemAddr, uint_t position) {
   return;
 }
 
-void vector_delete(vector_t *v, uint_t position) {
+void vector_erase_range(vector_t *v, size_t position, size_t n) {
+  assert(position <= vector_len(v) && n <= vector_len(v) - position);
+  if (n == 0)
+    return;
+  char *p_pos = (char *) vector_data(v) + position * v->elem_size;
+  // free the n elements ...
+  if (v->free_fun != NULL)
+    for (size_t k = 0; k < n; k++)
+      v->free_fun(p_pos + k * v->elem_size);
+  // ... then do the left shift of the whole tail in one go
+  size_t tail = vector_len(v) - position - n;
+  memmove(p_pos,
+          p_pos + n * v->elem_size,
+          tail * v->elem_size);
+  v->size -= n;
+  return;
+}
+
+void vector_delete(vector_t *v, size_t position) {
   assert(position < vector_len(v));
-  // delete pos
-  void *p_pos = vector_nth(v, position);
-  if (v->free_fun != NULL && p_pos != NULL)
-    v->free_fun(p_pos);
-  // now do the left shift
-  for (uint_t cpos = position + 1; cpos < vector_len(v); cpos++) {
-    void *p_curr = vector_nth(v, cpos);
-    memmove(p_pos,
-            p_curr,
-            v->elem_size);
-    p_pos = p_curr;
-  }
-  v->size--;
-  return;
-}
-
-static void vector_realloc(vector_t *v) {
-  // re-allocation
-  v->chunk_num++;
-  v->headptr = realloc(v->headptr, v->chunk_num * v->chunk_size * v->elem_size);
-  //                                    2       *    4          *    x byte(s)   (e.g.: x == 1 for char) 
-  if (v->headptr == NULL) {
+  vector_erase_range(v, position, 1);
+  return;
+}
+
+/*
+ * Single pass compaction: the kept elements are moved down (in runs, with one
+ * memmove per run) over the removed ones, hence O(n) whatever the number of
+ * removed elements.
+ */
+size_t vector_remove_if(vector_t *v, vector_pred_fun_t pred_fun, void *auxData) {
+  assert(pred_fun != NULL);
+  //
+  char *base = (char *) vector_data(v);
+  size_t dst = 0;     // where the next kept element goes
+  size_t run = 0;     // start of the current run of kept elements
+  for (size_t pos = 0; pos <= vector_len(v); pos++) {
+    if (pos < vector_len(v) && !pred_fun(base + pos * v->elem_size, auxData))
+      continue;
+    // pos is to be removed (or is the end): move the run [run, pos) down
+    if (run != dst && pos > run)
+      memmove(base + dst * v->elem_size,
+              base + run * v->elem_size,
+              (pos - run) * v->elem_size);
+    dst += pos - run;
+    run  = pos + 1;
+    if (pos < vector_len(v) && v->free_fun != NULL)
+      v->free_fun(base + pos * v->elem_size);
+  }
+  size_t removed = vector_len(v) - dst;
+  v->size = dst;
+  return removed;
+}
+
+size_t vector_dedup_sorted(vector_t *v, vector_cmp_fun_t cmp_fun) {
+  assert(cmp_fun != NULL);
+  //
+  if (vector_len(v) < 2)
+    return 0;
+  char *base = (char *) vector_data(v);
+  size_t last = 0;   // last kept element
+  for (size_t pos = 1; pos < vector_len(v); pos++) {
+    char *p_curr = base + pos * v->elem_size;
+    char *p_last = base + last * v->elem_size;
+    if (cmp_fun(p_last, p_curr) == 0) {
+      if (v->free_fun != NULL)
+        v->free_fun(p_curr);
+    }
+    else {
+      last++;
+      if (last != pos)
+        memcpy(p_last + v->elem_size, p_curr, v->elem_size);
+    }
+  }
+  size_t removed = vector_len(v) - (last + 1);
+  v->size = last + 1;
+  return removed;
+}
+
+size_t vector_capacity(const vector_t *v) {
+  return v->capacity;
+}
+
+static void vector_set_capacity(vector_t *v, size_t capacity) {
+  size_t inline_capacity = VECTOR_INLINE_BYTES / v->elem_size;
+  assert(capacity >= v->size);
+  if (capacity <= inline_capacity) {
+    // (1) the elements fit in the small buffer: move them back in
+    if (v->headptr != NULL) {
+      memcpy(v->inline_buf.bytes, v->headptr, v->size * v->elem_size);
+      vector_release(v);
+      v->headptr = NULL;
+    }
+    v->capacity = inline_capacity;
+    return;
+  }
+  // (2) heap storage: re-allocation to exactly capacity slots, or first
+  //     spill out of the small buffer (or out of a file mapping)
+  if (capacity > SIZE_MAX / v->elem_size)
+    vector_overflow();
+  bool on_heap = v->headptr != NULL && !(v->flags & kMapped);
+  void *ptr = on_heap
+    ? v->alloc->realloc(v->alloc->ctx, v->headptr, v->capacity * v->elem_size, capacity * v->elem_size)
+    : v->alloc->alloc(v->alloc->ctx, capacity * v->elem_size);
+  //                      cap. * x byte(s)   (e.g.: x == 1 for char) 
+  if (ptr == NULL) {
     perror("could not allocate space for the vector chunk");
-    // Free the initial memory block.
+    // the initial memory block is still valid, free it.
     vector_dispose(v);
     exit(EXIT_FAILURE);
   }
+  if (!on_heap) {
+    memcpy(ptr, vector_data(v), v->size * v->elem_size);
+    if (v->headptr != NULL)
+      vector_release(v);
+  }
+  v->headptr  = ptr;
+  v->capacity = capacity;
+  return;
+}
+
+static void vector_realloc(vector_t *v, size_t min_capacity) {
+  // geometric growth: double the capacity (at least by one chunk)
+  // so that a run of vector_append is amortized O(1)
+  size_t step = (v->capacity > v->chunk_size) ? v->capacity : v->chunk_size;
+  // (capped to the largest allocatable capacity, i.e. SIZE_MAX bytes)
+  size_t max_capacity = SIZE_MAX / v->elem_size;
+  if (step > max_capacity - v->capacity)
+    step = (v->capacity < max_capacity) ? max_capacity - v->capacity : 0;
+  size_t capacity = v->capacity + step;
+  if (capacity < min_capacity)
+    capacity = min_capacity;
+  vector_set_capacity(v, capacity);
+  return;
+}
+
+void vector_reserve(vector_t *v, size_t n) {
+  if (n > v->capacity)
+    vector_set_capacity(v, n);
+  return;
+}
+
+void vector_shrink_to_fit(vector_t *v) {
+  if (v->size < v->capacity)
+    vector_set_capacity(v, v->size);
   return;
 }
 
-void vector_insert(vector_t *v, const void *elemAddr, uint_t position) {
-  printf("[!] vector_insert at position: %d // logical size: %d\n",
-         position,
-         v->size);
+void vector_insert_range(vector_t *v, const void *elemsAddr, size_t n, size_t position) {
   // check
-  assert(position <= v->size);
+  assert(position <= vector_len(v));
+  if (n > SIZE_MAX - vector_len(v))   // logical length would wrap
+    vector_overflow();
+  if (n == 0)
+    return;
+  assert(elemsAddr != NULL);
   //
-  if (v->size == 0 || position ==  vector_len(v)) {
-    // insert into an empty vector == vector_append
-    vector_append(v, elemAddr);
-  }
-  else {
-    assert(position >= 0 && position < vector_len(v));
-    //
-    // 2 cases - realloc or not
-    if (vector_len(v) == v->chunk_num * v->chunk_size)
-      vector_realloc(v);
-    //
-    // incr logical size
-    uint_t laspos_t = vector_len(v) - 1; // before incr. the size to allow for the right shift
-    v->size++;
-    for(uint_t cpos = laspos_t; cpos > position; cpos--) { 
-      void *p_curr = vector_nth(v, cpos);
-      void *p_dst  = vector_nth(v, cpos + 1);
-      memmove(p_dst,
-              p_curr,
-              v->elem_size);
-    }
-    // cpos == position, but it did not memmove the item at position 0
-    // special case at position == 0
-    if (position == 0) {
-      void *p_curr = vector_nth(v, position);
-      void *p_dst  = vector_nth(v, position + 1);
-      memmove(p_dst,
-              p_curr,
-              v->elem_size);
-    }
-    // do the insert - get the position for insertion
-    void *p_pos  = vector_nth(v, position);
-    memcpy(p_pos, elemAddr, v->elem_size);    
-  }  
+  // 2 cases - realloc or not
+  if (vector_len(v) + n > v->capacity)
+    vector_realloc(v, vector_len(v) + n);
+  //
+  // right shift of the whole tail at once, then copy the n new elements
+  char *p_pos = (char *) vector_data(v) + position * v->elem_size;
+  size_t tail = vector_len(v) - position;
+  if (tail > 0)
+    memmove(p_pos + n * v->elem_size,
+            p_pos,
+            tail * v->elem_size);
+  memcpy(p_pos, elemsAddr, n * v->elem_size);
+  v->size += n;
+  return;
+}
+
+void vector_append_n(vector_t *v, const void *elemsAddr, size_t n) {
+  vector_insert_range(v, elemsAddr, n, vector_len(v));
+  return;
+}
+
+void vector_insert(vector_t *v, const void *elemAddr, size_t position) {
+  TRACE_DEBUG("insert at position: %zu // logical size: %zu", position, v->size);
+  vector_insert_range(v, elemAddr, 1, position);
   return;
 }
 
 void vector_append(vector_t *v, const void *elemAddr) {
-  
-  if (vector_len(v) == v->chunk_num * v->chunk_size) { 
-    vector_realloc(v);
-  }  
-  // incr size
-  uint_t pos = vector_len(v);
-  v->size++;  
-  // find the position (last one)
-  void *ptr = vector_nth(v, pos);
-  if (ptr == NULL) {
-    perror("could not find the position");
-    vector_dispose(v);
-    exit(EXIT_FAILURE);
-  }  
-  // do the copy
-  if (memcpy(ptr, elemAddr, v->elem_size) != ptr) {
-    perror("memcpy failed to make the copy\n");
-    vector_dispose(v);
-    exit(EXIT_FAILURE);
-  }
+  vector_insert_range(v, elemAddr, 1, vector_len(v));
   return;
 }
 
-static const int kNotFound = -1;
+static const ptrdiff_t kNotFound = -1;
 
-int vector_search(const vector_t *v, const void *key, vector_cmp_fun_t search_fun, uint_t startIndex, bool isSorted) { 
+/*
+ * Binary search over [startIndex, len) of a vector_t sorted according to cmp_fun.
+ * As for bsearch(3), cmp_fun is called with the key first and an element second.
+ * Returns the first position whose element is not less than the key (lower bound)
+ * or, if upper is true, the first position whose element is greater than the key
+ * (upper bound); len if there is none.
+ */
+static size_t vector_bound(const vector_t *v, const void *key, vector_cmp_fun_t cmp_fun,
+                           size_t startIndex, bool upper) {
+  size_t lo = startIndex, hi = vector_len(v);
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    int res = cmp_fun(key, (char *) vector_data(v) + mid * v->elem_size);
+    if (res > 0 || (upper && res == 0))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
 
-  /**
-     void * bsearch(const void *key, const void *base, size_t nmemb, size_t size, 
-                    int (*compar) (const void *, const void *));
-
-     The bsearch() function searches an array of nmemb objects, the initial
-     member of which is pointed to by base, for a member that matches the
-     object pointed to by key.  The size of each member of the array is speci‐
-     fied by size.
-
-     The contents of the array should be in ascending sorted order according
-     to the comparison function referenced by compar.  The compar routine is
-     expected to have two arguments which point to the key object and to an
-     array member, in that order, and should return an integer less than,
-     equal to, or greater than zero if the key object is found, respectively,
-     to be less than, to match, or be greater than the array member.  See the
-     incompare_t sample function in qsort(3) for a comparison function that is
-     also compatible with bsearch().
-
-     RETURN VALUES
-     The bsearch() function returns a pointer to a matching member of the
-     array, or a null pointer if no match is found.  If two members compare as
-     equal, which member is matched is unspecified.
-  */
+size_t vector_lower_bound(const vector_t *v, const void *key, vector_cmp_fun_t cmp_fun) {
+  assert(cmp_fun != NULL);
+  return vector_bound(v, key, cmp_fun, 0, false);
+}
+
+size_t vector_upper_bound(const vector_t *v, const void *key, vector_cmp_fun_t cmp_fun) {
+  assert(cmp_fun != NULL);
+  return vector_bound(v, key, cmp_fun, 0, true);
+}
+
+void vector_equal_range(const vector_t *v, const void *key, vector_cmp_fun_t cmp_fun,
+                        size_t *first, size_t *last) {
+  assert(cmp_fun != NULL && first != NULL && last != NULL);
+  *first = vector_bound(v, key, cmp_fun, 0, false);
+  *last  = vector_bound(v, key, cmp_fun, *first, true);
+}
+
+size_t vector_insert_sorted(vector_t *v, const void *elemAddr, vector_cmp_fun_t cmp_fun) {
+  assert(cmp_fun != NULL);
+  // insert after the equal elements, so the insertion order of equals is kept
+  size_t position = vector_bound(v, elemAddr, cmp_fun, 0, true);
+  vector_insert_range(v, elemAddr, 1, position);
+  return position;
+}
+
+ptrdiff_t vector_search(const vector_t *v, const void *key, vector_cmp_fun_t search_fun, size_t startIndex, bool isSorted) { 
 
   if (v == NULL || startIndex == vector_len(v))
     return kNotFound;
@@ -197,18 +344,19 @@ int vector_search(const vector_t *v, const void *key, vector_cmp_fun_t search_fu
   assert(search_fun != NULL);
   
   if (isSorted) {
-    // binary search by calling bsearch
-    void *ptr = bsearch(key, v->headptr, vector_len(v), v->elem_size, search_fun);
-    if (ptr == NULL)
-       return kNotFound;
-    else
-      return (uint_t) ((char *)ptr - (char *) v->headptr) / v->elem_size;                
+    // binary search (lower bound) within [startIndex, len), so the first
+    // matching element from startIndex on is returned
+    size_t pos = vector_bound(v, key, search_fun, startIndex, false);
+    if (pos < vector_len(v) &&
+        search_fun(key, (char *) vector_data(v) + pos * v->elem_size) == 0)
+      return pos;
+    return kNotFound;
   }
   else {
     // linear search
-    printf(">>>=== linear search\n");
-    for(uint_t pos = startIndex; pos < vector_len(v); pos++) {
-      void *p_curr = (char *) v->headptr + pos * v->elem_size;      
+    TRACE_DEBUG("linear search from index %zu", startIndex);
+    for(size_t pos = startIndex; pos < vector_len(v); pos++) {
+      void *p_curr = (char *) vector_data(v) + pos * v->elem_size;      
       if (search_fun(p_curr, key) == 0)
         return pos;
     }
@@ -216,6 +364,86 @@ int vector_search(const vector_t *v, const void *key, vector_cmp_fun_t search_fu
   }
 } 
 
+/*
+ * SIMD scan for vector_find_bytes: compares VECTOR_SIMD_BYTES bytes at once to
+ * the key repeated across a register, then folds the byte mask so that only the
+ * elements whose bytes all matched are kept.  SSE2 is part of the x86-64
+ * baseline, AVX2 is used when the compiler targets it (e.g. -mavx2).
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VECTOR_SIMD_BYTES 32
+typedef __m256i simd_t;
+#define simd_load(p)       _mm256_loadu_si256((const simd_t *) (p))
+#define simd_eq_mask(a, b) ((uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8((a), (b))))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VECTOR_SIMD_BYTES 16
+typedef __m128i simd_t;
+#define simd_load(p)       _mm_loadu_si128((const simd_t *) (p))
+#define simd_eq_mask(a, b) ((uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8((a), (b))))
+#endif
+
+#ifdef VECTOR_SIMD_BYTES
+static size_t vector_find_simd(const char *base, size_t n, size_t es, const void *key) {
+  // the key repeated over a whole register (es divides VECTOR_SIMD_BYTES)
+  char pattern[VECTOR_SIMD_BYTES];
+  for (size_t k = 0; k < VECTOR_SIMD_BYTES; k += es)
+    memcpy(pattern + k, key, es);
+  simd_t needle = simd_load(pattern);
+  // bits at the first byte of each element
+  uint32_t lanes = 0;
+  for (size_t k = 0; k < VECTOR_SIMD_BYTES; k += es)
+    lanes |= (uint32_t) 1 << k;
+  //
+  size_t per_block = VECTOR_SIMD_BYTES / es;
+  size_t pos = 0;
+  for (; n - pos >= per_block; pos += per_block) {
+    uint32_t mask = simd_eq_mask(simd_load(base + pos * es), needle);
+    if (mask == 0)
+      continue;
+    // keep bit k*es iff the es bits from k*es on are all set
+    for (size_t shift = 1; shift < es; shift <<= 1)
+      mask &= mask >> shift;
+    mask &= lanes;
+    if (mask != 0)
+      return pos + __builtin_ctz(mask) / es;
+  }
+  // scalar tail
+  for (; pos < n; pos++)
+    if (memcmp(base + pos * es, key, es) == 0)
+      return pos;
+  return n;
+}
+#endif
+
+ptrdiff_t vector_find_bytes(const vector_t *v, const void *key, size_t startIndex) {
+  if (v == NULL || startIndex == vector_len(v))
+    return kNotFound;
+  assert(startIndex < vector_len(v));
+  assert(key != NULL);
+  //
+  size_t es = v->elem_size;
+  const char *base = (const char *) vector_data(v) + startIndex * es;
+  size_t n = vector_len(v) - startIndex;
+  size_t pos = n;
+  if (es == 1) {
+    // libc's memchr is already vectorized
+    const char *p = memchr(base, *(const unsigned char *) key, n);
+    pos = (p == NULL) ? n : (size_t) (p - base);
+  }
+#ifdef VECTOR_SIMD_BYTES
+  else if (es == 2 || es == 4 || es == 8 || es == 16)
+    pos = vector_find_simd(base, n, es, key);
+#endif
+  else {
+    for (pos = 0; pos < n; pos++)
+      if (memcmp(base + pos * es, key, es) == 0)
+        break;
+  }
+  return (pos == n) ? kNotFound : (ptrdiff_t) (startIndex + pos);
+}
+
 void vector_sort(vector_t *v, vector_cmp_fun_t cmp_fun) {
   assert(cmp_fun != NULL);
   /**
@@ -236,14 +464,460 @@ void vector_sort(vector_t *v, vector_cmp_fun_t cmp_fun) {
      less than, equal to, or greater than the second.
    *
    */
-  qsort(v->headptr, vector_len(v), v->elem_size, cmp_fun); 
+  qsort(vector_data(v), vector_len(v), v->elem_size, cmp_fun); 
+  return;
+}
+
+/*
+ * Worker threads
+ * --------------
+ * Runs work_fun on each of the count argument blocks (of arg_size bytes each)
+ * stored contiguously at args: the first one in the calling thread, the others
+ * in worker threads, then waits for all of them.  If a thread cannot be created
+ * its work is done by the calling thread instead.
+ */
+typedef void *(*vector_work_fun_t)(void *arg);
+
+static void vector_run_workers(vector_work_fun_t work_fun, void *args, size_t arg_size, uint_t count) {
+  pthread_t tids[count];
+  bool      started[count];
+  for (uint_t k = 1; k < count; k++)
+    started[k] = pthread_create(&tids[k], NULL, work_fun, (char *) args + k * arg_size) == 0;
+  work_fun(args);
+  for (uint_t k = 1; k < count; k++) {
+    if (started[k])
+      pthread_join(tids[k], NULL);
+    else
+      work_fun((char *) args + k * arg_size);
+  }
+}
+
+// number of workers to use: nthreads, or one per online CPU if nthreads is 0
+static uint_t vector_num_workers(uint_t nthreads) {
+  if (nthreads == 0) {
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = (ncpus > 0) ? (uint_t) ncpus : 1;
+  }
+  return (nthreads > kMaxWorkers) ? kMaxWorkers : nthreads;
+}
+
+// below this many elements per thread, parallel sorting does not pay off
+static const uint_t kMinParallelSortRun = 8192;
+
+typedef struct {
+  char             *base;     // sort: run to sort  / merge: source buffer
+  char             *dst;      // merge: destination buffer
+  size_t           lo, mid, hi;
+  size_t           elem_size;
+  vector_cmp_fun_t cmp_fun;
+} sort_job_t;
+
+static void *sort_worker(void *arg) {
+  sort_job_t *job = arg;
+  qsort(job->base + job->lo * job->elem_size, job->hi - job->lo, job->elem_size, job->cmp_fun);
+  return NULL;
+}
+
+// stable merge of the sorted runs [lo, mid) and [mid, hi) of base into dst
+static void *merge_worker(void *arg) {
+  sort_job_t *job = arg;
+  size_t es = job->elem_size;
+  char *left  = job->base + job->lo * es, *left_end  = job->base + job->mid * es;
+  char *right = left_end,                 *right_end = job->base + job->hi * es;
+  char *out   = job->dst + job->lo * es;
+  while (left < left_end && right < right_end) {
+    if (job->cmp_fun(right, left) < 0) {
+      memcpy(out, right, es);
+      right += es;
+    }
+    else {
+      memcpy(out, left, es);
+      left += es;
+    }
+    out += es;
+  }
+  memcpy(out, left, left_end - left);
+  out += left_end - left;
+  memcpy(out, right, right_end - right);
+  return NULL;
+}
+
+void vector_sort_parallel(vector_t *v, vector_cmp_fun_t cmp_fun, uint_t nthreads) {
+  assert(cmp_fun != NULL);
+  //
+  size_t n = vector_len(v);
+  uint_t nruns = vector_num_workers(nthreads);
+  if (nruns > n / kMinParallelSortRun)
+    nruns = n / kMinParallelSortRun;
+  if (nruns < 2) {
+    vector_sort(v, cmp_fun);
+    return;
+  }
+  char *scratch = malloc(n * v->elem_size);
+  if (scratch == NULL) {    // not enough memory for the merge, sort in place
+    vector_sort(v, cmp_fun);
+    return;
+  }
+  //
+  // (1) partition into nruns contiguous runs, qsort-ed concurrently
+  size_t bounds[nruns + 1];
+  sort_job_t jobs[nruns];
+  for (uint_t k = 0; k <= nruns; k++)
+    bounds[k] = n * k / nruns;
+  for (uint_t k = 0; k < nruns; k++)
+    jobs[k] = (sort_job_t) { .base = vector_data(v), .lo = bounds[k], .hi = bounds[k + 1],
+                             .elem_size = v->elem_size, .cmp_fun = cmp_fun };
+  vector_run_workers(sort_worker, jobs, sizeof(sort_job_t), nruns);
+  //
+  // (2) merge pairs of adjacent runs, concurrently, ping-ponging between the
+  //     vector's storage and the scratch buffer, until a single run is left
+  char *src = vector_data(v), *dst = scratch;
+  while (nruns > 1) {
+    uint_t nmerges = nruns / 2;
+    for (uint_t k = 0; k < nmerges; k++)
+      jobs[k] = (sort_job_t) { .base = src, .dst = dst, .lo = bounds[2 * k],
+                               .mid = bounds[2 * k + 1], .hi = bounds[2 * k + 2],
+                               .elem_size = v->elem_size, .cmp_fun = cmp_fun };
+    if (nruns % 2 == 1)   // odd run out: just copy it over
+      memcpy(dst + bounds[nruns - 1] * v->elem_size, src + bounds[nruns - 1] * v->elem_size,
+             (bounds[nruns] - bounds[nruns - 1]) * v->elem_size);
+    vector_run_workers(merge_worker, jobs, sizeof(sort_job_t), nmerges);
+    // the boundaries of the merged runs
+    for (uint_t k = 0; k <= nruns / 2; k++)
+      bounds[k] = bounds[2 * k];
+    if (nruns % 2 == 1)
+      bounds[nruns / 2 + 1] = n;
+    nruns = (nruns + 1) / 2;
+    char *tmp = src; src = dst; dst = tmp;
+  }
+  if (src != vector_data(v))
+    memcpy(vector_data(v), src, n * v->elem_size);
+  free(scratch);
+  return;
+}
+
+// n blocks of sz bytes
+static void *vector_xmalloc(size_t n, size_t sz) {
+  if (sz != 0 && n > SIZE_MAX / sz)
+    vector_overflow();
+  void *ptr = malloc(n * sz);
+  if (ptr == NULL) {
+    perror("could not allocate scratch space for the vector");
+    exit(EXIT_FAILURE);
+  }
+  return ptr;
+}
+
+void vector_radix_sort(vector_t *v, vector_key_fun_t key_fun, uint_t key_bits) {
+  assert(key_fun != NULL);
+  assert(key_bits > 0 && key_bits <= 64);
+  //
+  size_t n = vector_len(v), es = v->elem_size;
+  if (n < 2)
+    return;
+  uint_t npasses = (key_bits + 7) / 8;   // one pass per 8-bit digit
+  //
+  // (1) extract every key once, and build the histograms of all digits at once
+  uint64_t *keys     = vector_xmalloc(n, sizeof(uint64_t));
+  uint64_t *keys_tmp = vector_xmalloc(n, sizeof(uint64_t));
+  char     *scratch  = vector_xmalloc(n, es);
+  size_t (*counts)[256] = calloc(npasses, sizeof(*counts));
+  if (counts == NULL) {
+    perror("could not allocate scratch space for the vector");
+    exit(EXIT_FAILURE);
+  }
+  for (size_t k = 0; k < n; k++) {
+    uint64_t key = key_fun((char *) vector_data(v) + k * es);
+    keys[k] = key;
+    for (uint_t pass = 0; pass < npasses; pass++)
+      counts[pass][(key >> (8 * pass)) & 0xFF]++;
+  }
+  //
+  // (2) one stable counting sort pass per digit, least significant first,
+  //     ping-ponging between the vector's storage and the scratch buffer
+  char *src = vector_data(v), *dst = scratch;
+  for (uint_t pass = 0; pass < npasses; pass++) {
+    uint_t shift = 8 * pass;
+    size_t offsets[256], sum = 0;
+    if (counts[pass][(keys[0] >> shift) & 0xFF] == n)
+      continue;   // all keys share this digit, the pass would not move anything
+    for (uint_t d = 0; d < 256; d++) {
+      offsets[d] = sum;
+      sum += counts[pass][d];
+    }
+    for (size_t k = 0; k < n; k++) {
+      size_t pos = offsets[(keys[k] >> shift) & 0xFF]++;
+      keys_tmp[pos] = keys[k];
+      memcpy(dst + pos * es, src + k * es, es);
+    }
+    uint64_t *tmp_keys = keys; keys = keys_tmp; keys_tmp = tmp_keys;
+    char *tmp = src; src = dst; dst = tmp;
+  }
+  if (src != vector_data(v))
+    memcpy(vector_data(v), src, n * es);
+  free(counts);
+  free(scratch);
+  free(keys_tmp);
+  free(keys);
+  return;
+}
+
+/*
+ * Records of vector_sort_by_key: the key (at offset 0), then the position of
+ * its element (at kRecIndexOffset).  Records are aligned for any key type.
+ */
+typedef union {
+  long double ld;
+  long long   ll;
+  void        *ptr;
+} sort_key_align_t;
+
+typedef struct {
+  char             *base;      // the records
+  size_t           rec_size;
+  vector_cmp_fun_t key_cmp;
+} key_sort_t;
+
+static inline size_t round_up(size_t n, size_t step) {
+  return (n + step - 1) / step * step;
+}
+
+// stable insertion sort of the records [lo, hi)
+static void key_insertion_sort(const key_sort_t *ks, size_t lo, size_t hi, char *tmp) {
+  size_t rs = ks->rec_size;
+  for (size_t k = lo + 1; k < hi; k++) {
+    size_t j = k;
+    memcpy(tmp, ks->base + k * rs, rs);
+    for (; j > lo && ks->key_cmp(tmp, ks->base + (j - 1) * rs) < 0; j--)
+      ;
+    if (j < k) {
+      memmove(ks->base + (j + 1) * rs, ks->base + j * rs, (k - j) * rs);
+      memcpy(ks->base + j * rs, tmp, rs);
+    }
+  }
+}
+
+// below this many records, runs are sorted by insertion
+static const size_t kKeySortRun = 16;
+
+void vector_sort_by_key(vector_t *v, vector_extract_fun_t key_fun, size_t key_size,
+                        vector_cmp_fun_t key_cmp) {
+  assert(key_fun != NULL && key_cmp != NULL && key_size > 0);
+  //
+  size_t n = vector_len(v), es = v->elem_size;
+  if (n < 2)
+    return;
+  size_t index_offset = round_up(key_size, sizeof(size_t));
+  if (index_offset < key_size)
+    vector_overflow();
+  size_t rs = round_up(index_offset + sizeof(size_t), sizeof(sort_key_align_t));
+  //
+  // (1) extract every key once, next to the position of its element
+  char *recs    = vector_xmalloc(n, rs);
+  char *scratch = vector_xmalloc(n, rs);
+  char *tmp     = vector_xmalloc(1, (rs > es) ? rs : es);
+  for (size_t k = 0; k < n; k++) {
+    key_fun((char *) vector_data(v) + k * es, recs + k * rs);
+    memcpy(recs + k * rs + index_offset, &k, sizeof(size_t));
+  }
+  //
+  // (2) stable bottom-up merge sort of the records: insertion sorted runs,
+  //     then merged pairwise, ping-ponging between recs and scratch
+  key_sort_t ks = { .base = recs, .rec_size = rs, .key_cmp = key_cmp };
+  for (size_t lo = 0; lo < n; lo += kKeySortRun)
+    key_insertion_sort(&ks, lo, (n - lo < kKeySortRun) ? n : lo + kKeySortRun, tmp);
+  char *src = recs, *dst = scratch;
+  for (size_t width = kKeySortRun; width < n; width *= 2) {
+    for (size_t lo = 0; lo < n; lo += 2 * width) {
+      size_t mid = (n - lo < width) ? n : lo + width;
+      size_t hi  = (n - mid < width) ? n : mid + width;
+      sort_job_t job = { .base = src, .dst = dst, .lo = lo, .mid = mid, .hi = hi,
+                         .elem_size = rs, .cmp_fun = key_cmp };
+      merge_worker(&job);
+    }
+    char *t = src; src = dst; dst = t;
+  }
+  //
+  // (3) src[k] now holds the position of the element which goes to k: move
+  //     the elements along the cycles of this permutation, marking the
+  //     positions done (index == k) on the way
+  for (size_t start = 0; start < n; start++) {
+    size_t from;
+    memcpy(&from, src + start * rs + index_offset, sizeof(size_t));
+    if (from == start)
+      continue;
+    char *base = vector_data(v);
+    memcpy(tmp, base + start * es, es);
+    size_t k = start;
+    while (from != start) {
+      memcpy(base + k * es, base + from * es, es);
+      memcpy(src + k * rs + index_offset, &k, sizeof(size_t));
+      k = from;
+      memcpy(&from, src + k * rs + index_offset, sizeof(size_t));
+    }
+    memcpy(base + k * es, tmp, es);
+    memcpy(src + k * rs + index_offset, &k, sizeof(size_t));
+  }
+  free(tmp);
+  free(scratch);
+  free(recs);
+  return;
+}
+
+/*
+ * Selection
+ * ---------
+ * Binary heaps on raw element arrays.  dir selects the kind of heap: with
+ * dir > 0 the root is the greatest element (max-heap), with dir < 0 it is the
+ * smallest one (min-heap).
+ */
+static void vector_swap(char *a, char *b, size_t es) {
+  char buf[64];
+  while (es > 0) {
+    size_t chunk = (es < sizeof(buf)) ? es : sizeof(buf);
+    memcpy(buf, a, chunk);
+    memcpy(a, b, chunk);
+    memcpy(b, buf, chunk);
+    a += chunk; b += chunk; es -= chunk;
+  }
+}
+
+// true if a belongs above b in the heap
+static inline bool heap_above(const void *a, const void *b, vector_cmp_fun_t cmp_fun, int dir) {
+  int res = cmp_fun(a, b);
+  return (dir > 0) ? res > 0 : res < 0;
+}
+
+static void heap_sift_down(char *base, size_t es, size_t n, size_t pos, vector_cmp_fun_t cmp_fun, int dir) {
+  for (;;) {
+    size_t child = 2 * pos + 1;
+    if (child >= n)
+      break;
+    if (child + 1 < n && heap_above(base + (child + 1) * es, base + child * es, cmp_fun, dir))
+      child++;
+    if (!heap_above(base + child * es, base + pos * es, cmp_fun, dir))
+      break;
+    vector_swap(base + pos * es, base + child * es, es);
+    pos = child;
+  }
+}
+
+static void heap_make(char *base, size_t es, size_t n, vector_cmp_fun_t cmp_fun, int dir) {
+  for (size_t pos = n / 2; pos > 0; pos--)
+    heap_sift_down(base, es, n, pos - 1, cmp_fun, dir);
+}
+
+// heap sort: ascending order for a max-heap, descending for a min-heap
+static void heap_sort(char *base, size_t es, size_t n, vector_cmp_fun_t cmp_fun, int dir) {
+  for (size_t end = n; end > 1; end--) {
+    vector_swap(base, base + (end - 1) * es, es);
+    heap_sift_down(base, es, end - 1, 0, cmp_fun, dir);
+  }
+}
+
+// moves the k smallest of the n elements to the front, as a max-heap
+static void heap_select(char *base, size_t es, size_t k, size_t n, vector_cmp_fun_t cmp_fun) {
+  heap_make(base, es, k, cmp_fun, 1);
+  for (size_t pos = k; pos < n; pos++)
+    if (cmp_fun(base + pos * es, base) < 0) {
+      vector_swap(base, base + pos * es, es);
+      heap_sift_down(base, es, k, 0, cmp_fun, 1);
+    }
+}
+
+// below this many elements, vector_nth_element sorts by insertion
+static const size_t kSmallSelect = 16;
+
+void vector_nth_element(vector_t *v, size_t nth, vector_cmp_fun_t cmp_fun) {
+  assert(cmp_fun != NULL);
+  assert(nth < vector_len(v));
+  //
+  char *base = vector_data(v);
+  size_t es = v->elem_size, lo = 0, hi = vector_len(v);
+  char *pivot = vector_xmalloc(1, es);
+  uint_t depth = 0;
+  for (size_t n = hi; n > 1; n >>= 1)
+    depth += 2;   // 2 * log2(n) partitions before giving up on quickselect
+  while (hi - lo > kSmallSelect) {
+    if (depth-- == 0) {
+      // too many bad pivots: heap select the nth - lo + 1 smallest of [lo, hi),
+      // the greatest of which (at the root) goes to nth
+      heap_select(base + lo * es, es, nth - lo + 1, hi - lo, cmp_fun);
+      vector_swap(base + lo * es, base + nth * es, es);
+      free(pivot);
+      return;
+    }
+    // median of three, which also plants sentinels at lo and last
+    char *p_lo = base + lo * es, *p_mid = base + (lo + (hi - lo) / 2) * es, *p_last = base + (hi - 1) * es;
+    if (cmp_fun(p_mid, p_lo) < 0)
+      vector_swap(p_mid, p_lo, es);
+    if (cmp_fun(p_last, p_mid) < 0) {
+      vector_swap(p_last, p_mid, es);
+      if (cmp_fun(p_mid, p_lo) < 0)
+        vector_swap(p_mid, p_lo, es);
+    }
+    memcpy(pivot, p_mid, es);
+    size_t i = lo, j = hi - 1;
+    for (;;) {
+      do i++; while (cmp_fun(base + i * es, pivot) < 0);
+      do j--; while (cmp_fun(pivot, base + j * es) < 0);
+      if (i >= j)
+        break;
+      vector_swap(base + i * es, base + j * es, es);
+    }
+    // [lo, j] <= pivot <= [j + 1, hi): keep on with the side holding nth
+    if (nth <= j)
+      hi = j + 1;
+    else
+      lo = j + 1;
+  }
+  free(pivot);
+  // insertion sort of the few elements left
+  for (size_t pos = lo + 1; pos < hi; pos++)
+    for (size_t k = pos; k > lo && cmp_fun(base + (k - 1) * es, base + k * es) > 0; k--)
+      vector_swap(base + (k - 1) * es, base + k * es, es);
+  return;
+}
+
+void vector_partial_sort(vector_t *v, size_t k, vector_cmp_fun_t cmp_fun) {
+  assert(cmp_fun != NULL);
+  assert(k <= vector_len(v));
+  //
+  heap_select(vector_data(v), v->elem_size, k, vector_len(v), cmp_fun);
+  heap_sort(vector_data(v), v->elem_size, k, cmp_fun, 1);
+  return;
+}
+
+void vector_topk(const vector_t *v, size_t k, vector_cmp_fun_t cmp_fun, vector_t *out) {
+  assert(cmp_fun != NULL && out != NULL);
+  assert(out->elem_size == v->elem_size);
+  //
+  size_t es = v->elem_size, n = vector_len(v);
+  if (k > n)
+    k = n;
+  if (k == 0)
+    return;
+  // the best k elements seen so far, in a min-heap: the root is the one
+  // to evict when a better element comes along
+  const char *base = vector_data(v);
+  char *heap = vector_xmalloc(k, es);
+  memcpy(heap, base, k * es);
+  heap_make(heap, es, k, cmp_fun, -1);
+  for (size_t pos = k; pos < n; pos++)
+    if (cmp_fun(base + pos * es, heap) > 0) {
+      memcpy(heap, base + pos * es, es);
+      heap_sift_down(heap, es, k, 0, cmp_fun, -1);
+    }
+  heap_sort(heap, es, k, cmp_fun, -1);   // greatest first
+  vector_append_n(out, heap, k);
+  free(heap);
   return;
 }
 
 void vector_map(vector_t *v, vector_map_fun_t map_fun, void *auxData) {
   assert(map_fun != NULL);
   //
-  for (uint_t pos = 0; pos < vector_len(v); pos++) {
+  for (size_t pos = 0; pos < vector_len(v); pos++) {
     void *p = vector_nth(v, pos);
     map_fun(p, auxData);
   }
@@ -251,5 +925,182 @@ void vector_map(vector_t *v, vector_map_fun_t map_fun, void *auxData) {
   return;
 }
 
+typedef struct {
+  char                 *base;
+  size_t               lo, hi;
+  size_t               elem_size;
+  vector_map_fun_t     map_fun;
+  vector_reduce_fun_t  reduce_fun;
+  void                 *accAddr;     // reduce: the partial accumulator of the chunk
+  void                 *auxData;
+} map_job_t;
+
+static void *map_worker(void *arg) {
+  map_job_t *job = arg;
+  for (size_t pos = job->lo; pos < job->hi; pos++)
+    job->map_fun(job->base + pos * job->elem_size, job->auxData);
+  return NULL;
+}
+
+static void *reduce_worker(void *arg) {
+  map_job_t *job = arg;
+  for (size_t pos = job->lo; pos < job->hi; pos++)
+    job->reduce_fun(job->accAddr, job->base + pos * job->elem_size, job->auxData);
+  return NULL;
+}
 
+// splits [0, len) into one contiguous chunk per worker (at most one per element)
+static uint_t vector_map_jobs(const vector_t *v, uint_t nthreads, map_job_t *jobs) {
+  size_t n = vector_len(v);
+  uint_t nchunks = vector_num_workers(nthreads);
+  if (nchunks > n)
+    nchunks = (n > 0) ? n : 1;
+  for (uint_t k = 0; k < nchunks; k++)
+    jobs[k] = (map_job_t) { .base = vector_data(v), .lo = n * k / nchunks, .hi = n * (k + 1) / nchunks,
+                            .elem_size = v->elem_size };
+  return nchunks;
+}
 
+void vector_map_parallel(vector_t *v, vector_map_fun_t map_fun, void *auxData, uint_t nthreads) {
+  assert(map_fun != NULL);
+  //
+  map_job_t jobs[kMaxWorkers];
+  uint_t nchunks = vector_map_jobs(v, nthreads, jobs);
+  for (uint_t k = 0; k < nchunks; k++) {
+    jobs[k].map_fun = map_fun;
+    jobs[k].auxData = auxData;
+  }
+  vector_run_workers(map_worker, jobs, sizeof(map_job_t), nchunks);
+  return;
+}
+
+void vector_reduce(const vector_t *v, void *accAddr, vector_reduce_fun_t reduce_fun, void *auxData) {
+  assert(accAddr != NULL && reduce_fun != NULL);
+  //
+  for (size_t pos = 0; pos < vector_len(v); pos++)
+    reduce_fun(accAddr, (char *) vector_data(v) + pos * v->elem_size, auxData);
+  return;
+}
+
+void vector_reduce_parallel(const vector_t *v, void *accAddr, size_t accSize,
+                            vector_reduce_fun_t reduce_fun, vector_combine_fun_t combine_fun,
+                            void *auxData, uint_t nthreads) {
+  assert(accAddr != NULL && accSize > 0);
+  assert(reduce_fun != NULL && combine_fun != NULL);
+  //
+  map_job_t jobs[kMaxWorkers];
+  uint_t nchunks = vector_map_jobs(v, nthreads, jobs);
+  // one partial accumulator per chunk, each starting from the identity in *accAddr
+  char *partials = vector_xmalloc(nchunks, accSize);
+  for (uint_t k = 0; k < nchunks; k++) {
+    memcpy(partials + k * accSize, accAddr, accSize);
+    jobs[k].reduce_fun = reduce_fun;
+    jobs[k].accAddr    = partials + k * accSize;
+    jobs[k].auxData    = auxData;
+  }
+  vector_run_workers(reduce_worker, jobs, sizeof(map_job_t), nchunks);
+  // combine the partial results, in the order of the chunks
+  for (uint_t k = 0; k < nchunks; k++)
+    combine_fun(accAddr, partials + k * accSize, auxData);
+  free(partials);
+  return;
+}
+
+/*
+ * Persistence
+ * -----------
+ * File layout: a kFileHeaderSize bytes header, then the count elements,
+ * contiguous, as they are in memory (native endianness).  The header is
+ * padded so that the elements of a mapped file are well aligned.
+ */
+static const char     kFileMagic[8]   = "VECTOR1";
+static const uint32_t kFileVersion    = 1;
+static const size_t   kFileHeaderSize = 64;
+
+typedef struct {
+  char     magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t elem_size;
+  uint64_t count;
+} vector_file_header_t;
+
+// gives the storage back: free the heap chunk or unmap the file
+static void vector_release(vector_t *v) {
+  if (v->flags & kMapped) {
+    char *base = (char *) v->headptr - kFileHeaderSize;
+    if (v->flags & kMappedShared)   // the elements were updated in place
+      ((vector_file_header_t *) base)->count = v->size;
+    munmap(base, kFileHeaderSize + v->capacity * v->elem_size);
+    v->flags &= ~(kMapped | kMappedShared);
+  }
+  else if (v->headptr != NULL)
+    v->alloc->free(v->alloc->ctx, v->headptr, v->capacity * v->elem_size);
+}
+
+bool vector_save(const vector_t *v, const char *path) {
+  assert(v != NULL && path != NULL);
+  //
+  char header[kFileHeaderSize];
+  vector_file_header_t hdr = { .version = kFileVersion, .elem_size = v->elem_size, .count = v->size };
+  memcpy(hdr.magic, kFileMagic, sizeof(hdr.magic));
+  memset(header, 0, kFileHeaderSize);
+  memcpy(header, &hdr, sizeof(hdr));
+  //
+  FILE *fp = fopen(path, "wb");
+  if (fp == NULL)
+    return false;
+  size_t nbytes = v->size * v->elem_size;
+  bool ok = fwrite(header, 1, kFileHeaderSize, fp) == kFileHeaderSize &&
+            (nbytes == 0 || fwrite(vector_data(v), 1, nbytes, fp) == nbytes);
+  if (fclose(fp) != 0)
+    ok = false;
+  return ok;
+}
+
+bool vector_open_mmap(vector_t *v, const char *path, bool readonly) {
+  assert(v != NULL && path != NULL);
+  //
+  int fd = open(path, readonly ? O_RDONLY : O_RDWR);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < kFileHeaderSize) {
+    close(fd);
+    return false;
+  }
+  //
+  // readonly: private (copy-on-write) mapping, the vector_t can still be
+  // modified in place but the file is never written.  Otherwise: shared
+  // mapping, the updates go straight to the file.
+  char *base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                    readonly ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+  close(fd);   // the mapping stays valid
+  if (base == MAP_FAILED)
+    return false;
+  //
+  vector_file_header_t hdr;
+  memcpy(&hdr, base, sizeof(hdr));
+  if (memcmp(hdr.magic, kFileMagic, sizeof(hdr.magic)) != 0 || hdr.version != kFileVersion ||
+      hdr.elem_size == 0 || (size_t) hdr.elem_size != hdr.elem_size ||
+      hdr.count > ((size_t) st.st_size - kFileHeaderSize) / hdr.elem_size) {
+    munmap(base, st.st_size);
+    return false;
+  }
+  //
+  vector_new(v, hdr.elem_size, NULL, 0);
+  v->size     = hdr.count;
+  v->capacity = hdr.count;   // kFileHeaderSize + capacity * elem_size is the mapped length
+  v->headptr  = base + kFileHeaderSize;
+  v->flags    = readonly ? kMapped : (kMapped | kMappedShared);
+  if (kFileHeaderSize + (size_t) hdr.count * hdr.elem_size != (size_t) st.st_size) {
+    // trailing bytes (e.g. elements deleted from a shared mapping): only keep
+    // the mapping of what is used, so the mapped length can be recomputed
+    size_t used = kFileHeaderSize + (size_t) hdr.count * hdr.elem_size;
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t keep = (used + page - 1) / page * page;
+    if (keep < (size_t) st.st_size)
+      munmap(base + keep, st.st_size - keep);
+  }
+  return true;
+}
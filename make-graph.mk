@@ -53,6 +53,7 @@ OBJS     += $(OBJ3)
 ## main
 DSTFILE   = $(.CURDIR)/bin/$(MYNAME)
 SRC       = $(.CURDIR)/src/$(MYNAME).c
+INC      += $(.CURDIR)/src/counting_allocator.h   # test allocator_t
 _OBJ      = $(SRC:.c=.o)
 OBJ       = ${_OBJ:C/src/obj/}
 OBJS     += $(OBJ)
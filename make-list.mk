@@ -25,7 +25,7 @@ CC        = /usr/bin/clang
 LL        = $(CC)
 #
 .if defined(DEBUG)
-CFLAGS     = -std=c99 -O0 -g -pg -Wall -pipe
+CFLAGS     = -std=c99 -O0 -g -pg -Wall -pipe -DTRACE_LEVEL=4
 CFLAGS_L   = -std=c99 -O0 -Wall -pipe
 .else
 CFLAGS     = -std=c99 -O2 -Wall -pipe
@@ -37,6 +37,7 @@ CFLAGS_L   = $(CFLAGS)
 SRC1      = $(.CURDIR)/lib/$(MYNAME).c
 OBJ1      = $(.CURDIR)/obj/$(MYNAME).o 
 INC      += $(.CURDIR)/inc/$(MYNAME).h
+INC      += $(.CURDIR)/inc/prefetch.h
 OBJS     += $(OBJ1)
 
 SRC2      = $(.CURDIR)/lib/my_malloc.c
@@ -45,9 +46,15 @@ INC      += $(.CURDIR)/inc/my_malloc.h
 OBJS     += $(OBJ2)
 
 
+SRC3      = $(.CURDIR)/lib/trace.c
+OBJ3      = $(.CURDIR)/obj/trace.o 
+INC      += $(.CURDIR)/inc/trace.h
+OBJS     += $(OBJ3)
+
 ## main
 DSTFILE   = $(.CURDIR)/bin/test_$(MYNAME)
 SRC       = $(.CURDIR)/src/test_$(MYNAME).c
+INC      += $(.CURDIR)/src/counting_allocator.h   # test allocator_t
 _OBJ      = $(SRC:.c=.o)
 OBJ       = ${_OBJ:C/src/obj/}
 OBJS     += $(OBJ)
@@ -76,6 +83,10 @@ $(OBJ2): $(SRC2)
 	$(CC) $(CFLAGS) $(INCDRS) -c $(SRC2) -o $@
 
 
+$(OBJ3): $(SRC3)
+	@echo "-- object stage with [$(OBJ3) // [$@]]"
+	$(CC) $(CFLAGS) $(INCDRS) -c $(SRC3) -o $@
+
 $(OBJ): $(SRC)
 	@echo " - object stage with [$(OBJ)]"
 	$(CC) $(CFLAGS) $(INCDRS) -c $(SRC) -o ${OBJ}
@@ -104,6 +115,6 @@ depend:
 # do some vacuum cleaning
 #
 clean:
-	@$(RM) -f $(OBJ) $(OBJ1) $(OBJ2)
+	@$(RM) -f $(OBJ) $(OBJ1) $(OBJ2) $(OBJ3)
 	@$(RM) -f $(DSTFILE)
 	@$(FIND) $(.CURDIR) -type f -name "*~" -delete
@@ -0,0 +1,84 @@
+#define _POSIX_C_SOURCE 200809L   // for clock_gettime with -std=c99
+
+#include "vector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <assert.h>
+
+/**
+ * File: bench_vector.c
+ * --------------------
+ * Benchmarks vector_sort (i.e. qsort) against vector_sort_parallel on
+ * vectors of random elements of various sizes.  Each element carries a
+ * 32-bit key in its first 4 bytes, the rest is padding, so that the cost
+ * of moving elements around grows with the element size.
+ *
+ * Usage: bench_vector [num_elements [num_threads]]
+ *        (num_threads 0, the default, means one per online CPU)
+ */
+
+static const size_t kelem_sizes[] = { 4, 8, 16, 64, 256 };
+
+static int cmp_key(const void *elemA, const void *elemB) {
+  uint32_t a, b;
+  memcpy(&a, elemA, sizeof(a));
+  memcpy(&b, elemB, sizeof(b));
+  return (a > b) - (a < b);
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void fill_random(vector_t *v, uint_t n, size_t elem_size) {
+  char elem[256] = { 0 };
+  assert(elem_size <= sizeof(elem));
+  srand(107);
+  vector_reserve(v, n);
+  for (uint_t k = 0; k < n; k++) {
+    uint32_t key = ((uint32_t) rand() << 16) ^ (uint32_t) rand();
+    memcpy(elem, &key, sizeof(key));
+    vector_append(v, elem);
+  }
+}
+
+static void check_sorted(const vector_t *v) {
+  for (uint_t k = 1; k < vector_len(v); k++)
+    assert(cmp_key(vector_nth(v, k - 1), vector_nth(v, k)) <= 0);
+}
+
+int main(int argc, char **argv) {
+  uint_t n        = (argc > 1) ? (uint_t) strtoul(argv[1], NULL, 10) : 2000000;
+  uint_t nthreads = (argc > 2) ? (uint_t) strtoul(argv[2], NULL, 10) : 0;
+
+  printf("%10s %10s %14s %14s %8s\n", "elem_size", "count", "qsort (ms)", "parallel (ms)", "speedup");
+  for (int k = 0; k < sizeof(kelem_sizes) / sizeof(kelem_sizes[0]); k++) {
+    vector_t v;
+    double start, t_qsort, t_parallel;
+
+    vector_new(&v, kelem_sizes[k], NULL, 0);
+    fill_random(&v, n, kelem_sizes[k]);
+    start = now_ms();
+    vector_sort(&v, cmp_key);
+    t_qsort = now_ms() - start;
+    check_sorted(&v);
+    vector_dispose(&v);
+
+    vector_new(&v, kelem_sizes[k], NULL, 0);
+    fill_random(&v, n, kelem_sizes[k]);
+    start = now_ms();
+    vector_sort_parallel(&v, cmp_key, nthreads);
+    t_parallel = now_ms() - start;
+    check_sorted(&v);
+    vector_dispose(&v);
+
+    printf("%10zu %10u %14.1f %14.1f %7.2fx\n",
+           kelem_sizes[k], n, t_qsort, t_parallel, t_qsort / t_parallel);
+  }
+  return 0;
+}
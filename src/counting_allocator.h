@@ -0,0 +1,65 @@
+/**
+ * File: counting_allocator.h
+ * --------------------------
+ * A test allocator_t (see my_malloc.h) on top of malloc, realloc and free,
+ * which keeps count of its calls and of the bytes it handed out and did
+ * not get back yet.  A container created with it has given all its memory
+ * back, each block with the size it was allocated with, when live_bytes is
+ * 0 and num_allocs == num_frees.
+ *
+ *   struct counting_allocator counts;
+ *   const allocator_t alloc = counting_allocator(&counts);
+ *   vector_new_with(&v, sizeof(long), NULL, 0, &alloc);
+ *   ...
+ *   vector_dispose(&v);
+ *   assert(counts.live_bytes == 0 && counts.num_allocs == counts.num_frees);
+ *
+ * Only meant to be included by the test programs of src/.
+ */
+
+#ifndef _counting_allocator_
+#define _counting_allocator_
+
+#include "my_malloc.h"
+#include <stdlib.h>
+#include <assert.h>
+
+struct counting_allocator {
+  size_t live_bytes;
+  unsigned int num_allocs;
+  unsigned int num_reallocs;
+  unsigned int num_frees;
+};
+
+static void *counting_alloc(void *ctx, size_t sz) {
+  struct counting_allocator *c = ctx;
+  c->live_bytes += sz;
+  c->num_allocs++;
+  return malloc(sz);
+}
+
+static void *counting_realloc(void *ctx, void *ptr, size_t old_sz, size_t new_sz) {
+  struct counting_allocator *c = ctx;
+  assert(c->live_bytes >= old_sz);
+  c->live_bytes += new_sz - old_sz;
+  c->num_reallocs++;
+  return realloc(ptr, new_sz);
+}
+
+static void counting_free(void *ctx, void *ptr, size_t sz) {
+  struct counting_allocator *c = ctx;
+  assert(c->live_bytes >= sz);
+  c->live_bytes -= sz;
+  c->num_frees++;
+  free(ptr);
+}
+
+// resets counts and returns an allocator_t counting into it
+static inline allocator_t counting_allocator(struct counting_allocator *counts) {
+  allocator_t alloc = { counting_alloc, counting_realloc, counting_free, counts };
+  counts->live_bytes   = 0;
+  counts->num_allocs   = counts->num_reallocs = counts->num_frees = 0;
+  return alloc;
+}
+
+#endif
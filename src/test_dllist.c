@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include "dllist.h"
+#include "counting_allocator.h"
 
 
 typedef struct person_ {
@@ -139,11 +140,44 @@ int main(int argc, char **argv) {
   test_delete_person(lst, &p1);
   //
   dllist_iter(lst);
+  //
+  // callback-free iteration: head to tail, then back
+  const person_t *expected[] = { &p3, &p2 };
+  int n = 0;
+  DLLIST_FOREACH(lst, itm) {
+    assert(dllist_data(itm) == expected[n]);
+    n++;
+  }
+  assert(n == 2);
+  DLLIST_FOREACH_REVERSE(lst, itm) {
+    n--;
+    assert(dllist_data(itm) == expected[n]);
+  }
+  assert(n == 0);
+  printf("[+] OK DLLIST_FOREACH visited the items both ways...\n");
   // free
   dllist_free(&lst);
   assert(lst == NULL);
   printf("[+] OK list destroyed...\n");
 
+  // the list and its items come from the given allocator
+  struct counting_allocator counts;
+  const allocator_t alloc = counting_allocator(&counts);
+  if (! dllist_new_with(&lst, &person_match, NULL, &cb, &alloc)) {
+    printf("Error: could not allocate room for a new list\n");
+    return(1);
+  }
+  dllist_ins_next(lst, NULL, &p1);
+  dllist_ins_next(lst, NULL, &p2);
+  dllist_ins_next(lst, NULL, &p3);
+  assert(counts.num_allocs == 1 + 3);
+  const person_t *p = &p2;
+  dllist_rem(lst, (void **) &p);
+  assert(dllist_size(lst) == 2 && counts.num_frees == 1);
+  dllist_free(&lst);
+  assert(counts.live_bytes == 0 && counts.num_allocs == counts.num_frees);
+  printf("[+] OK %u allocations, all given back to the allocator...\n", counts.num_allocs);
+
   return 0;
 }
 
@@ -3,6 +3,7 @@
 #include <assert.h>
 
 #include "graph.h"
+#include "counting_allocator.h"
 
 
 
@@ -137,7 +138,27 @@ int main(int argc, char **argv) {
   // free
   graph_free(&graph);
   assert(graph == NULL);
-  
+
+  // the graph, its adjacency lists and their items come from the allocator
+  struct counting_allocator counts;
+  const allocator_t alloc = counting_allocator(&counts);
+  graph_new(&graph, &i_match, NULL, &cb, &list_cb, .alloc = &alloc);
+  int vertices[] = { 2, 6, 4, 7, 5 };
+  for (int v = 0; v < 5; v++)
+    graph_ins_vertex(graph, &vertices[v]);
+  for (int v = 1; v < 5; v++)
+    graph_ins_edge(graph, &vertices[0], &vertices[v]);
+  graph_ins_edge(graph, &vertices[1], &vertices[2]);
+  pl = &vertices[3];
+  graph_rem_edge(graph, &vertices[0], (void **) &pl);
+  assert(graph_vcount(graph) == 5 && graph_ecount(graph) == 4);
+  // the graph, an adjlist_t and a list item per vertex, a list item per edge
+  assert(counts.num_allocs == 1 + 2 * 5 + 5 && counts.num_frees == 1);
+  graph_free(&graph);
+  assert(graph == NULL);
+  assert(counts.live_bytes == 0 && counts.num_allocs == counts.num_frees);
+  printf("[+] %u allocations, all given back to the allocator\n", counts.num_allocs);
+
 
   return 0;
 }
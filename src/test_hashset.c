@@ -1,7 +1,10 @@
+#define _POSIX_C_SOURCE 200809L   // for strdup with -std=c99
 #include "hashset.h"
 #include "vector.h"
+#include "counting_allocator.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include <limits.h>
 #include <assert.h>
@@ -22,9 +25,9 @@ struct frequency {
  * which is the proper range for our hashset_t.
  */
 
-static int hash_frequency(const void *elem, int numBuckets) {
+static size_t hash_frequency(const void *elem, size_t numBuckets) {
   struct frequency *freq = (struct frequency *)elem;
-  return (freq->ch % numBuckets);
+  return ((unsigned char) freq->ch % numBuckets);
 }
 
 /**
@@ -156,8 +159,428 @@ static void test_hash_table(void) {
   hashset_dispose(&counts);
 }
 
+/**
+ * Function: test_robin_hood
+ * -------------------------
+ * Counts the letters again with the Robin Hood engine, which must agree
+ * with the chained one.  Then enters many integers in a Robin Hood
+ * hashset_t created with a handful of slots, so that it grows many times
+ * over, and checks lookups of present and absent keys, replacement (with
+ * the free function called on the old element) and the map.
+ */
+
+struct pair {
+  long key;
+  long value;
+};
+
+static size_t hash_pair(const void *elem, size_t numBuckets) {
+  unsigned long key = ((const struct pair *) elem)->key;
+  return (size_t) ((key * 0x9E3779B97F4A7C15UL) >> 7) % numBuckets;
+}
+
+static int cmp_pair(const void *elem1, const void *elem2) {
+  long a = ((const struct pair *) elem1)->key, b = ((const struct pair *) elem2)->key;
+  return (a > b) - (a < b);
+}
+
+static size_t num_replaced = 0;
+
+static void free_pair(void *elem) {
+  num_replaced++;
+}
+
+static void sum_values(void *elem, void *sum) {
+  *(long *) sum += ((struct pair *) elem)->value;
+}
+
+static void test_robin_hood(void) {
+  hashset_t chained, robin, pairs;
+  const long n = 200000;
+
+  fprintf(stdout, "\n\n ------------------------- Starting the Robin Hood test\n");
+  hashset_new(&chained, sizeof(struct frequency), kNumBuckets, hash_frequency, cmp_letter, NULL);
+  hashset_new_engine(&robin, HASHSET_ROBIN_HOOD, sizeof(struct frequency), kNumBuckets,
+                     hash_frequency, cmp_letter, NULL, NULL);
+  build_table_of_letter_count(&chained);
+  build_table_of_letter_count(&robin);
+  assert(hashset_count(&robin) == hashset_count(&chained));
+  for (char ch = 'a'; ch <= 'z'; ch++) {
+    struct frequency key = { ch, 0 }, *f1 = hashset_lookup(&chained, &key), *f2 = hashset_lookup(&robin, &key);
+    assert((f1 == NULL && f2 == NULL) || (f1 != NULL && f2 != NULL && f1->occurrences == f2->occurrences));
+  }
+  hashset_dispose(&robin);
+  hashset_dispose(&chained);
+
+  hashset_new_engine(&pairs, HASHSET_ROBIN_HOOD, sizeof(struct pair), 8, hash_pair, cmp_pair, free_pair, NULL);
+  for (long k = 0; k < n; k++) {
+    struct pair p = { k * 3, k };
+    hashset_enter(&pairs, &p);
+  }
+  assert(hashset_count(&pairs) == (size_t) n && num_replaced == 0);
+  for (long k = 0; k < 3 * n; k++) {
+    struct pair key = { k, 0 }, *found = hashset_lookup(&pairs, &key);
+    assert((k % 3 == 0) ? (found != NULL && found->value == k / 3) : found == NULL);
+  }
+  for (long k = 0; k < n; k += 2) {
+    struct pair p = { k * 3, -k };
+    hashset_enter(&pairs, &p);
+  }
+  assert(hashset_count(&pairs) == (size_t) n && num_replaced == (size_t) n / 2);
+  long sum = 0;
+  hashset_map(&pairs, sum_values, &sum);
+  assert(sum == -(n / 2) * (n / 2 - 1) + (n / 2) * (n / 2));   // -(0+2+...) + (1+3+...)
+  fprintf(stdout, "%ld pairs in %zu slots\n", n, pairs.num_buckets);
+  hashset_dispose(&pairs);
+  assert(num_replaced == (size_t) n / 2 + n);
+  fprintf(stdout, "[Robin Hood test done]\n");
+}
+
+/**
+ * Function: test_resize
+ * ---------------------
+ * For both engines: a hashset_t created with a single bucket grows as the
+ * elements come in and keeps the load factor within its maximum, all the
+ * elements staying reachable; hashset_reserve sizes it once for a known
+ * count; hashset_rehash shrinks it back and hashset_set_max_load rehashes
+ * it at once when lowered below the current load.
+ */
+
+static void check_pairs(const hashset_t *h, long n) {
+  assert(hashset_count(h) == (size_t) n);
+  for (long k = 0; k < 2 * n; k++) {
+    struct pair key = { k, 0 }, *found = hashset_lookup(h, &key);
+    assert((k < n) ? (found != NULL && found->value == k) : found == NULL);
+  }
+}
+
+static void test_resize(void) {
+  const long n = 50000;
+  fprintf(stdout, "\n\n ------------------------- Starting the resize test\n");
+  for (int engine = HASHSET_CHAINED; engine <= HASHSET_ROBIN_HOOD; engine++) {
+    hashset_t pairs;
+    hashset_new_engine(&pairs, engine, sizeof(struct pair), 1, hash_pair, cmp_pair, NULL, NULL);
+    for (long k = 0; k < n; k++) {
+      struct pair p = { k, k };
+      hashset_enter(&pairs, &p);
+      assert(hashset_count(&pairs) <= pairs.max_load * pairs.num_buckets);
+    }
+    check_pairs(&pairs, n);
+    size_t grown = pairs.num_buckets;
+
+    hashset_set_max_load(&pairs, 0.5);
+    assert(pairs.num_buckets > grown && hashset_count(&pairs) <= 0.5 * pairs.num_buckets);
+    check_pairs(&pairs, n);
+    hashset_rehash(&pairs, 4 * n);
+    assert(pairs.num_buckets == 4 * n);
+    check_pairs(&pairs, n);
+    hashset_rehash(&pairs, 1);
+    assert(pairs.num_buckets == 2 * n);
+    check_pairs(&pairs, n);
+    hashset_dispose(&pairs);
+
+    hashset_new_engine(&pairs, engine, sizeof(struct pair), 1, hash_pair, cmp_pair, NULL, NULL);
+    hashset_reserve(&pairs, n);
+    size_t reserved = pairs.num_buckets;
+    for (long k = 0; k < n; k++) {
+      struct pair p = { k, k };
+      hashset_enter(&pairs, &p);
+    }
+    assert(pairs.num_buckets == reserved);
+    check_pairs(&pairs, n);
+    fprintf(stdout, "%s: %ld elements, %zu buckets after growth, %zu reserved\n",
+            (engine == HASHSET_CHAINED) ? "chained" : "robin hood", n, grown, reserved);
+    hashset_dispose(&pairs);
+  }
+  fprintf(stdout, "[resize test done]\n");
+}
+
+/**
+ * Function: test_incremental
+ * --------------------------
+ * Grows a chained hashset_t with incremental rehashing from one bucket:
+ * every element must stay reachable while the two bucket arrays are live,
+ * replacements must find the element wherever it is, and disposing of the
+ * hashset_t in the middle of a rehash must free every element exactly once.
+ * With a tiny maximum load, the next growth comes after few enters: the
+ * old bucket array must still be empty by then.
+ */
+
+static void count_pair(void *elem, void *count) {
+  (*(size_t *) count)++;
+}
+
+static void test_incremental(void) {
+  hashset_t pairs;
+  const long n = 100000;
+  size_t steps_rehashing = 0, mapped = 0;
+  fprintf(stdout, "\n\n ------------------------- Starting the incremental rehash test\n");
+  hashset_new(&pairs, sizeof(struct pair), 1, hash_pair, cmp_pair, free_pair);
+  hashset_set_incremental(&pairs, true);
+  num_replaced = 0;
+  for (long k = 0; k < n; k++) {
+    struct pair p = { k, k };
+    hashset_enter(&pairs, &p);
+    if (hashset_rehashing(&pairs)) {
+      steps_rehashing++;
+      // the oldest and the latest elements, in either array
+      struct pair key = { k / 2, 0 }, *found = hashset_lookup(&pairs, &key);
+      assert(found != NULL && (found->value == k / 2 || found->value == -(k / 2)));
+      p.value = -k;
+      hashset_enter(&pairs, &p);
+      key.key = k;
+      found = hashset_lookup(&pairs, &key);
+      assert(found != NULL && found->value == -k);
+    }
+  }
+  assert(steps_rehashing > 0 && num_replaced == steps_rehashing);
+  hashset_map(&pairs, count_pair, &mapped);
+  assert(hashset_count(&pairs) == (size_t) n && mapped == (size_t) n);
+  // grow once more, then dispose halfway through the rehash
+  while (!hashset_rehashing(&pairs)) {
+    struct pair p = { n + (long) hashset_count(&pairs), 0 };
+    hashset_enter(&pairs, &p);
+  }
+  size_t count = hashset_count(&pairs);
+  fprintf(stdout, "%zu elements, %zu buckets, %zu enters during a rehash\n",
+          count, pairs.num_buckets, steps_rehashing);
+  num_replaced = 0;
+  hashset_dispose(&pairs);
+  assert(num_replaced == count);
+
+  size_t num_grows = 0;
+  const long m = n / 10;
+  hashset_new(&pairs, sizeof(struct pair), 1, hash_pair, cmp_pair, NULL);
+  hashset_set_max_load(&pairs, 0.01);
+  hashset_set_incremental(&pairs, true);
+  for (long k = 0; k < m; k++) {
+    struct pair p = { k, k };
+    bool was_rehashing = hashset_rehashing(&pairs);
+    size_t num_buckets = pairs.num_buckets;
+    hashset_enter(&pairs, &p);
+    if (pairs.num_buckets != num_buckets) {
+      assert(!was_rehashing);   // no stop-the-world end of the previous rehash
+      num_grows++;
+    }
+  }
+  check_pairs(&pairs, m);
+  fprintf(stdout, "max load 0.01: %zu buckets after %zu incremental grows\n", pairs.num_buckets, num_grows);
+  hashset_dispose(&pairs);
+  fprintf(stdout, "[incremental rehash test done]\n");
+}
+
+/**
+ * Function: test_cached_hash
+ * --------------------------
+ * Counts the calls of the hash and compare functions: one hash per enter
+ * or lookup and none while growing, since the hash codes are stored with
+ * the elements; and one compare per successful lookup, none (but for a
+ * full hash code collision) for a key which is absent.
+ */
+
+static size_t num_hashes = 0, num_compares = 0;
+
+static size_t counted_hash(const void *elem, size_t numBuckets) {
+  assert(numBuckets == SIZE_MAX);   // reduced by the hashset_t, with both engines
+  num_hashes++;
+  return hash_pair(elem, numBuckets);
+}
+
+static int counted_cmp(const void *elem1, const void *elem2) {
+  num_compares++;
+  return cmp_pair(elem1, elem2);
+}
+
+static void test_cached_hash(void) {
+  const long n = 20000;
+  fprintf(stdout, "\n\n ------------------------- Starting the cached hash test\n");
+  for (int engine = HASHSET_CHAINED; engine <= HASHSET_ROBIN_HOOD; engine++) {
+    hashset_t pairs;
+    hashset_new_engine(&pairs, engine, sizeof(struct pair), 1, counted_hash, counted_cmp, NULL, NULL);
+    hashset_set_max_load(&pairs, 0.9);
+    num_hashes = num_compares = 0;
+    for (long k = 0; k < n; k++) {
+      struct pair p = { k, k };
+      hashset_enter(&pairs, &p);
+    }
+    assert(num_hashes == (size_t) n && pairs.num_buckets > 1);
+    hashset_rehash(&pairs, 4 * n);
+    assert(num_hashes == (size_t) n);
+    num_hashes = num_compares = 0;
+    for (long k = 0; k < 2 * n; k++) {
+      struct pair key = { k, 0 };
+      assert((hashset_lookup(&pairs, &key) != NULL) == (k < n));
+    }
+    assert(num_hashes == (size_t) 2 * n && num_compares <= (size_t) n + n / 100);
+    fprintf(stdout, "%s: %zu compares for %ld lookups\n",
+            (engine == HASHSET_CHAINED) ? "chained" : "robin hood", num_compares, 2 * n);
+    hashset_dispose(&pairs);
+  }
+  fprintf(stdout, "[cached hash test done]\n");
+}
+
+/**
+ * Function: test_hashers
+ * ----------------------
+ * Checks the built-in hashers: hashset_hash_str agrees with
+ * hashset_hash_bytes, keys differing in length or in a single byte and
+ * different seeds give different codes, flipping one bit of an integer key
+ * flips about half the bits of its code, and sequential keys spread evenly
+ * over a power of two number of buckets taken from the low bits.  Then a
+ * hashset_new64 table of strings, for both engines.
+ */
+
+static int bit_count(uint64_t x) {
+  int n = 0;
+  for (; x != 0; x &= x - 1)
+    n++;
+  return n;
+}
+
+// chi-square statistic of n keys (key k is make_code(k)) over numBuckets buckets
+static double spread(uint64_t (*make_code)(long), long n, size_t numBuckets) {
+  size_t *counts = calloc(numBuckets, sizeof(size_t));
+  assert(counts != NULL);
+  for (long k = 0; k < n; k++)
+    counts[make_code(k) & (numBuckets - 1)]++;
+  double expected = (double) n / numBuckets, chi2 = 0.0;
+  for (size_t b = 0; b < numBuckets; b++)
+    chi2 += (counts[b] - expected) * (counts[b] - expected) / expected;
+  free(counts);
+  return chi2;
+}
+
+static uint64_t int_code(long k) {
+  return hashset_hash_u64((uint64_t) k);
+}
+
+static uint64_t string_code(long k) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "key-%ld", k);
+  return hashset_hash_str(buffer);
+}
+
+static int cmp_string(const void *elem1, const void *elem2) {
+  return strcmp(*(char * const *) elem1, *(char * const *) elem2);
+}
+
+static void free_string(void *elem) {
+  free(*(char **) elem);
+}
+
+static void test_hashers(void) {
+  unsigned char bytes[200];
+  uint64_t codes[201];
+  fprintf(stdout, "\n\n ------------------------- Starting the hashers test\n");
+  for (size_t k = 0; k < sizeof(bytes); k++)
+    bytes[k] = (unsigned char) (k * 37 + 11);
+  // every length, and every single byte change, gives a new code
+  for (size_t len = 0; len <= sizeof(bytes); len++) {
+    codes[len] = hashset_hash_bytes(bytes, len, 0);
+    assert(codes[len] == hashset_hash_bytes(bytes, len, 0));
+    assert(codes[len] != hashset_hash_bytes(bytes, len, 1));
+    for (size_t prev = 0; prev < len; prev++)
+      assert(codes[prev] != codes[len]);
+  }
+  for (size_t k = 0; k < sizeof(bytes); k++) {
+    bytes[k] ^= 1;
+    assert(hashset_hash_bytes(bytes, sizeof(bytes), 0) != codes[sizeof(bytes)]);
+    bytes[k] ^= 1;
+  }
+  const char *word = "antidisestablishmentarianism";
+  char copy[64];
+  strcpy(copy, word);
+  assert(hashset_hash_str(word) == hashset_hash_bytes(word, strlen(word), 0));
+  assert(hashset_hash_str(copy) == hashset_hash_str(word) && hashset_hash_str("") == hashset_hash_bytes("", 0, 0));
+  uint32_t key32 = 123456789;
+  uint64_t key64 = 123456789;
+  assert(hashset_hash_u32_elem(&key32) == hashset_hash_u64(key32) && hashset_hash_u64_elem(&key64) == hashset_hash_u64(key64));
+  char *p_word = copy;
+  assert(hashset_hash_str_elem(&p_word) == hashset_hash_str(word));
+
+  // avalanche: one flipped bit of the key flips half of the code on average
+  double flipped = 0.0;
+  for (uint64_t key = 0; key < 1000; key++)
+    for (int bit = 0; bit < 64; bit++)
+      flipped += bit_count(hashset_hash_u64(key) ^ hashset_hash_u64(key ^ (1ULL << bit)));
+  flipped /= 1000.0 * 64;
+  assert(flipped > 31.0 && flipped < 33.0);
+  // sequential keys over 1024 buckets (1023 degrees of freedom: the
+  // chi-square of a uniform spread is 1023 +- 45 or so)
+  double chi2_ints = spread(int_code, 100000, 1024), chi2_strings = spread(string_code, 100000, 1024);
+  assert(chi2_ints < 1300 && chi2_strings < 1300);
+  fprintf(stdout, "%.2f bits flipped out of 64, chi-square %.0f (integers) and %.0f (strings)\n",
+          flipped, chi2_ints, chi2_strings);
+
+  for (int engine = HASHSET_CHAINED; engine <= HASHSET_ROBIN_HOOD; engine++) {
+    hashset_t words;
+    const long n = 20000;
+    hashset_new64(&words, engine, sizeof(char *), 1000, hashset_hash_str_elem, cmp_string, free_string, NULL);
+    assert(words.num_buckets == 1024);
+    for (long k = 0; k < n; k++) {
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "key-%ld", k);
+      char *str = strdup(buffer);
+      hashset_enter(&words, &str);
+    }
+    assert(hashset_count(&words) == (size_t) n && (words.num_buckets & (words.num_buckets - 1)) == 0);
+    hashset_rehash(&words, 3 * n);
+    assert(words.num_buckets == 65536);
+    for (long k = 0; k < 2 * n; k++) {
+      char buffer[32], *key = buffer;
+      snprintf(buffer, sizeof(buffer), "key-%ld", k);
+      char **found = hashset_lookup(&words, &key);
+      assert((k < n) ? (found != NULL && strcmp(*found, buffer) == 0) : found == NULL);
+    }
+    hashset_dispose(&words);
+  }
+  fprintf(stdout, "[hashers test done]\n");
+}
+
+/**
+ * Function: test_allocator
+ * ------------------------
+ * For both engines, a hashset_t created with an allocator takes all its
+ * memory from it, through growth and an incremental rehash: a counting
+ * allocator checks that every block it handed out is given back, with the
+ * size it was allocated with, by hashset_dispose.
+ */
+
+static void test_allocator(void) {
+  const long n = 20000;
+  fprintf(stdout, "\n\n ------------------------- Starting the allocator test\n");
+  for (int engine = HASHSET_CHAINED; engine <= HASHSET_ROBIN_HOOD; engine++) {
+    struct counting_allocator counts;
+    const allocator_t alloc = counting_allocator(&counts);
+    hashset_t pairs;
+    if (engine == HASHSET_CHAINED) {
+      hashset_new_with(&pairs, sizeof(struct pair), 4, hash_pair, cmp_pair, NULL, &alloc);
+      hashset_set_incremental(&pairs, true);
+    }
+    else
+      hashset_new_engine(&pairs, engine, sizeof(struct pair), 4, hash_pair, cmp_pair, NULL, &alloc);
+    for (long k = 0; k < n; k++) {
+      struct pair p = { k, k };
+      hashset_enter(&pairs, &p);
+    }
+    check_pairs(&pairs, n);
+    assert(counts.live_bytes > 0);
+    hashset_dispose(&pairs);
+    assert(counts.live_bytes == 0 && counts.num_allocs == counts.num_frees);
+    fprintf(stdout, "%s engine: %u allocations, all given back\n",
+            (engine == HASHSET_CHAINED) ? "chained" : "Robin Hood", counts.num_allocs);
+  }
+  fprintf(stdout, "[allocator test done]\n");
+}
+
 int main(int ununsed, char **alsoUnused) {
   test_hash_table();	
+  test_robin_hood();
+  test_resize();
+  test_incremental();
+  test_cached_hash();
+  test_hashers();
+  test_allocator();
   return 0;
 }
 
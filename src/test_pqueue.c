@@ -0,0 +1,232 @@
+#define _POSIX_C_SOURCE 200809L   // for strdup with -std=c99
+#include "pqueue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+static int long_cmp(const void *vp1, const void *vp2) {
+  long a = *(const long *) vp1, b = *(const long *) vp2;
+  return (a > b) - (a < b);
+}
+
+/**
+ * Function: order_test
+ * --------------------
+ * Pushes a permutation with duplicates, then pops everything back: the
+ * elements must come out in non-decreasing order, for both arities.  The
+ * same again with the heap built at once by pqueue_heapify, whose handles
+ * are the positions in the source vector_t.
+ */
+
+static void order_test(uint_t arity) {
+  pqueue_t pq;
+  vector_t numbers;
+  const long n = 50000;
+  fprintf(stdout, " ------------------------- Starting the order test (arity %u)...\n", arity);
+  pqueue_new(&pq, sizeof(long), long_cmp, NULL, arity);
+  assert(pqueue_peek(&pq) == NULL);
+  for (long k = 0; k < n; k++) {
+    long value = (k * 7919) % 10007;
+    pqueue_push(&pq, &value);
+  }
+  assert(pqueue_len(&pq) == n);
+  long prev = -1, curr;
+  while (pqueue_len(&pq) > 0) {
+    assert(*(long *) pqueue_peek(&pq) >= prev);
+    pqueue_pop(&pq, &curr);
+    assert(curr >= prev);
+    prev = curr;
+  }
+
+  vector_new(&numbers, sizeof(long), NULL, n);
+  for (long k = 0; k < n; k++) {
+    long value = (k * 7919) % 10007;
+    vector_append(&numbers, &value);
+  }
+  pqueue_dispose(&pq);
+  pqueue_new(&pq, sizeof(long), long_cmp, NULL, arity);
+  pqueue_heapify(&pq, &numbers);
+  for (size_t k = 0; k < vector_len(&numbers); k += 97)
+    assert(*(long *) pqueue_get(&pq, k) == *(long *) vector_nth(&numbers, k));
+  for (prev = -1; pqueue_len(&pq) > 0; prev = curr) {
+    pqueue_pop(&pq, &curr);
+    assert(curr >= prev);
+  }
+  vector_dispose(&numbers);
+  pqueue_dispose(&pq);
+  fprintf(stdout, "[order test done]\n");
+}
+
+/**
+ * Function: dijkstra_test
+ * -----------------------
+ * Shortest paths from the corner of a grid with pseudo random edge weights,
+ * with one entry per vertex in the pqueue_t and pqueue_decrease_key when a
+ * shorter path is found; the distances are checked against a Bellman-Ford
+ * relaxation.
+ */
+
+#define kSide 60
+#define kVertices (kSide * kSide)
+
+struct entry {
+  long dist;
+  int  vertex;
+};
+
+static int entry_cmp(const void *vp1, const void *vp2) {
+  const struct entry *a = vp1, *b = vp2;
+  return (a->dist > b->dist) - (a->dist < b->dist);
+}
+
+static long weight(int from, int to) {
+  return 1 + ((from * 31 + to * 17) % 23);
+}
+
+static int neighbours(int vertex, int out[4]) {
+  int row = vertex / kSide, col = vertex % kSide, n = 0;
+  if (row > 0)         out[n++] = vertex - kSide;
+  if (row < kSide - 1) out[n++] = vertex + kSide;
+  if (col > 0)         out[n++] = vertex - 1;
+  if (col < kSide - 1) out[n++] = vertex + 1;
+  return n;
+}
+
+static void dijkstra_test(uint_t arity) {
+  static long dist[kVertices], expected[kVertices];
+  static pqueue_handle_t handle[kVertices];
+  static bool queued[kVertices];
+  pqueue_t pq;
+  fprintf(stdout, " ------------------------- Starting the dijkstra test (arity %u)...\n", arity);
+  pqueue_new(&pq, sizeof(struct entry), entry_cmp, NULL, arity);
+  for (int v = 0; v < kVertices; v++) {
+    dist[v] = (v == 0) ? 0 : 1L << 40;
+    queued[v] = false;
+  }
+  struct entry e = { 0, 0 };
+  handle[0] = pqueue_push(&pq, &e);
+  queued[0] = true;
+  while (pqueue_len(&pq) > 0) {
+    pqueue_pop(&pq, &e);
+    assert(!pqueue_contains(&pq, handle[e.vertex]));
+    queued[e.vertex] = false;
+    int next[4], nn = neighbours(e.vertex, next);
+    for (int k = 0; k < nn; k++) {
+      long d = e.dist + weight(e.vertex, next[k]);
+      if (d >= dist[next[k]])
+        continue;
+      dist[next[k]] = d;
+      struct entry better = { d, next[k] };
+      if (queued[next[k]]) {
+        pqueue_decrease_key(&pq, handle[next[k]], &better);
+        assert(((struct entry *) pqueue_get(&pq, handle[next[k]]))->dist == d);
+      } else {
+        handle[next[k]] = pqueue_push(&pq, &better);
+        queued[next[k]] = true;
+      }
+    }
+  }
+  pqueue_dispose(&pq);
+
+  for (int v = 0; v < kVertices; v++)
+    expected[v] = (v == 0) ? 0 : 1L << 40;
+  for (bool changed = true; changed; ) {
+    changed = false;
+    for (int v = 0; v < kVertices; v++) {
+      int next[4], nn = neighbours(v, next);
+      for (int k = 0; k < nn; k++)
+        if (expected[v] + weight(v, next[k]) < expected[next[k]]) {
+          expected[next[k]] = expected[v] + weight(v, next[k]);
+          changed = true;
+        }
+    }
+  }
+  assert(memcmp(dist, expected, sizeof(dist)) == 0);
+  fprintf(stdout, "distance to the far corner: %ld\n", dist[kVertices - 1]);
+  fprintf(stdout, "[dijkstra test done]\n");
+}
+
+/**
+ * Function: handle_test
+ * ---------------------
+ * Handles of popped elements are invalid and recycled; pqueue_update moves
+ * an element both ways; elements popped without being copied out and the
+ * ones left at dispose time go to the free function.  A pqueue_t emptied by
+ * pops and heapified again numbers its handles from 0, in the order of v.
+ */
+
+static int num_freed = 0;
+
+static void free_string(void *elem_addr) {
+  free(*(char **) elem_addr);
+  num_freed++;
+}
+
+static int string_cmp(const void *vp1, const void *vp2) {
+  return strcmp(*(char * const *) vp1, *(char * const *) vp2);
+}
+
+static void handle_test() {
+  const char *words[] = { "pear", "fig", "banana", "kiwi", "plum", "apple" };
+  pqueue_handle_t handles[6];
+  pqueue_t pq;
+  char *word;
+  fprintf(stdout, " ------------------------- Starting the handle test...\n");
+  pqueue_new(&pq, sizeof(char *), string_cmp, free_string, 2);
+  for (int k = 0; k < 6; k++) {
+    word = strdup(words[k]);
+    handles[k] = pqueue_push(&pq, &word);
+  }
+  pqueue_pop(&pq, &word);
+  assert(strcmp(word, "apple") == 0 && !pqueue_contains(&pq, handles[5]));
+  free(word);
+  // "pear" goes to the top, then "banana" to the bottom
+  word = strdup("aardvark");
+  free(*(char **) pqueue_get(&pq, handles[0]));
+  pqueue_update(&pq, handles[0], &word);
+  assert(*(char **) pqueue_peek(&pq) == word);
+  word = strdup("zebra");
+  free(*(char **) pqueue_get(&pq, handles[2]));
+  pqueue_update(&pq, handles[2], &word);
+  assert(strcmp(*(char **) pqueue_peek(&pq), "aardvark") == 0);
+  pqueue_pop(&pq, NULL);
+  assert(num_freed == 1);
+  // the handle of a popped element is reused
+  word = strdup("grape");
+  pqueue_handle_t h = pqueue_push(&pq, &word);
+  assert(h == handles[0] || h == handles[5]);
+  assert(strcmp(*(char **) pqueue_get(&pq, h), "grape") == 0);
+  pqueue_dispose(&pq);
+  assert(num_freed == 1 + 5);
+
+  // emptied by pops, then heapified: the handles are the positions in v
+  vector_t numbers;
+  long value;
+  pqueue_new(&pq, sizeof(long), long_cmp, NULL, 2);
+  for (value = 0; value < 3; value++)
+    pqueue_push(&pq, &value);
+  while (pqueue_len(&pq) > 0)
+    pqueue_pop(&pq, NULL);
+  vector_new(&numbers, sizeof(long), NULL, 0);
+  for (value = 12; value >= 10; value--)
+    vector_append(&numbers, &value);
+  pqueue_heapify(&pq, &numbers);
+  for (size_t k = 0; k < vector_len(&numbers); k++)
+    assert(*(long *) pqueue_get(&pq, k) == *(long *) vector_nth(&numbers, k));
+  value = 5;
+  pqueue_decrease_key(&pq, 2, &value);   // 10 down to 5
+  assert(*(long *) pqueue_peek(&pq) == 5 && *(long *) pqueue_get(&pq, 0) == 12);
+  vector_dispose(&numbers);
+  pqueue_dispose(&pq);
+  fprintf(stdout, "[handle test done]\n");
+}
+
+int main(int ignored, char **also_ignored) {
+  order_test(2);
+  order_test(4);
+  dijkstra_test(2);
+  dijkstra_test(4);
+  handle_test();
+  return 0;
+}
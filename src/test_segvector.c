@@ -0,0 +1,116 @@
+#include "segvector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/**
+ * Function: stable_address_test
+ * -----------------------------
+ * Appends lots of longs to a segvector_t, keeping the address of every
+ * 1000th element as returned by segvector_append, then checks that all
+ * these addresses are still valid (same address, same value) once the
+ * segvector_t has grown through many segments, and that indexed access
+ * agrees with them.
+ */
+
+static void stable_address_test() {
+  segvector_t numbers;
+  long *saved[1000];
+  fprintf(stdout, " ------------------------- Starting the stable address test...\n");
+  segvector_new(&numbers, sizeof(long), NULL, 10);   // rounded up to 16
+  assert(numbers.base_shift == 4);
+  for (long k = 0; k < 1000000; k++) {
+    long *p = segvector_append(&numbers, &k);
+    if (k % 1000 == 0)
+      saved[k / 1000] = p;
+  }
+  assert(segvector_len(&numbers) == 1000000);
+  fprintf(stdout, "1000000 longs in %u segments.\n", numbers.num_segments);
+  for (long k = 0; k < 1000; k++) {
+    assert(*saved[k] == k * 1000);
+    assert(segvector_nth(&numbers, k * 1000) == saved[k]);
+  }
+  for (size_t pos = 0; pos < segvector_len(&numbers); pos++)
+    assert(*(long *) segvector_nth(&numbers, pos) == pos);
+  segvector_dispose(&numbers);
+  fprintf(stdout, "[stable address test done]\n");
+}
+
+/**
+ * Function: memory_test
+ * ---------------------
+ * Stores dynamically allocated C-strings: exercises replace, pop and map
+ * and relies on the free function to release every string (run it
+ * under valgrind or ASan to check nothing leaks).
+ */
+
+static char *copy_string(const char *s) {
+  char *copy = malloc(strlen(s) + 1);
+  assert(copy != NULL);
+  return strcpy(copy, s);
+}
+
+static void free_string(void *elem_addr) {
+  free(*(char **) elem_addr);
+}
+
+static void count_chars(void *elem_addr, void *aux_data) {
+  *(size_t *) aux_data += strlen(*(char **) elem_addr);
+}
+
+static void memory_test() {
+  segvector_t words;
+  char buffer[32];
+  fprintf(stdout, "\n ------------------------- Starting the memory test...\n");
+  segvector_new(&words, sizeof(char *), free_string, 0);
+  for (int k = 0; k < 100; k++) {
+    snprintf(buffer, sizeof(buffer), "%d", k);
+    char *word = copy_string(buffer);
+    segvector_append(&words, &word);
+  }
+  char *word = copy_string("hundred");
+  segvector_replace(&words, &word, 99);
+  segvector_pop(&words);
+  segvector_pop(&words);
+  assert(segvector_len(&words) == 98);
+  size_t nchars = 0;
+  segvector_map(&words, count_chars, &nchars);
+  assert(nchars == 10 + 88 * 2);
+  segvector_dispose(&words);
+  fprintf(stdout, "[memory test done]\n");
+}
+
+/**
+ * Function: large_element_test
+ * ----------------------------
+ * Elements larger than 64KB: each one is stored and copied whole, at a
+ * stride of its full size.
+ */
+
+#define kLargeSize 70000
+
+static void large_element_test() {
+  segvector_t blobs;
+  static unsigned char blob[kLargeSize];
+  fprintf(stdout, "\n ------------------------- Starting the large element test...\n");
+  segvector_new(&blobs, kLargeSize, NULL, 2);
+  assert(blobs.elem_size == kLargeSize);
+  for (int k = 0; k < 20; k++) {
+    memset(blob, k, kLargeSize);
+    segvector_append(&blobs, blob);
+  }
+  for (int k = 0; k < 20; k++) {
+    const unsigned char *p = segvector_nth(&blobs, k);
+    assert(p[0] == k && p[kLargeSize / 2] == k && p[kLargeSize - 1] == k);
+  }
+  segvector_dispose(&blobs);
+  fprintf(stdout, "[large element test done]\n");
+}
+
+int main(int ignored, char **also_ignored) {
+  stable_address_test();
+  memory_test();
+  large_element_test();
+  return 0;
+}
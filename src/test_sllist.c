@@ -3,6 +3,7 @@
 #include <assert.h>
 
 #include "sllist.h"
+#include "counting_allocator.h"
 
 /*
 void list_iter(sllist_t *lst) {
@@ -103,6 +104,44 @@ int main(int argc, char **argv) {
 
   list_free(&lst);
   assert(lst == NULL);
+
+  // callback-free iteration
+  int values[] = { 3, 1, 4, 1, 5 }, nvalues = sizeof(values) / sizeof(values[0]);
+  if (list_new(&lst, &i_match, NULL, &cb) != 0) {
+    printf("Error: could not allocate room for a new list\n");
+    return(1);
+  }
+  for (int n = nvalues - 1; n >= 0; n--)
+    list_ins_next(lst, NULL, &values[n]);
+  int n = 0;
+  LIST_FOREACH(lst, itm) {
+    assert(list_data(itm) == &values[n]);
+    n++;
+  }
+  assert(n == nvalues && list_size(lst) == nvalues);
+  printf("[+] LIST_FOREACH visited the %d items in order\n", n);
+  list_free(&lst);
+
+  // the list and its items come from the given allocator
+  struct counting_allocator counts;
+  const allocator_t alloc = counting_allocator(&counts);
+  if (list_new_with(&lst, &i_match, NULL, &cb, &alloc) != 0) {
+    printf("Error: could not allocate room for a new list\n");
+    return(1);
+  }
+  for (n = 0; n < nvalues; n++)
+    list_ins_next(lst, list_tail(lst), &values[n]);
+  assert(counts.num_allocs == 1 + nvalues);
+  int *pv = &values[2];
+  list_rem(lst, (void **) &pv);
+  pv = &values[0];
+  list_rem(lst, (void **) &pv);
+  list_rem_next(lst, NULL, (void **) &pv);
+  assert(pv == &values[1] && list_size(lst) == nvalues - 3);
+  assert(counts.num_frees == 3);
+  list_free(&lst);
+  assert(counts.live_bytes == 0 && counts.num_allocs == counts.num_frees);
+  printf("[+] %u allocations, all given back to the allocator\n", counts.num_allocs);
   //
   return 0;
 }
@@ -0,0 +1,79 @@
+#include "soa.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+typedef struct {
+  int    id;
+  double price;
+  char   flag;
+  float  weight;
+} item_t;
+
+static const soa_column_t kItemColumns[] = {
+  SOA_COLUMN(item_t, id),
+  SOA_COLUMN(item_t, price),
+  SOA_COLUMN(item_t, flag),
+  SOA_COLUMN(item_t, weight),
+};
+static const size_t kNumItemColumns = sizeof(kItemColumns) / sizeof(kItemColumns[0]);
+
+static item_t make_item(int k) {
+  item_t item = { .id = k, .price = k * 0.5, .flag = (k % 3 == 0) ? 'y' : 'n', .weight = k % 10 };
+  return item;
+}
+
+/**
+ * Function: column_test
+ * ---------------------
+ * Appends many records to a soa_t, checks that every column is a plain
+ * contiguous array of its field, that a column scan (sum of the prices
+ * of the flagged items) gives the same result as a row by row scan, and
+ * that records come back whole from soa_get_row.
+ */
+
+static void column_test() {
+  soa_t items;
+  const int n = 100000;
+  fprintf(stdout, " ------------------------- Starting the column test...\n");
+  soa_new(&items, kItemColumns, kNumItemColumns, sizeof(item_t), 0);
+  for (int k = 0; k < n; k++) {
+    item_t item = make_item(k);
+    soa_append(&items, &item);
+  }
+  assert(soa_len(&items) == n);
+
+  // column scan
+  const int    *ids    = soa_column(&items, 0);
+  const double *prices = soa_column(&items, 1);
+  const char   *flags  = soa_column(&items, 2);
+  double total = 0.0;
+  for (size_t k = 0; k < soa_len(&items); k++) {
+    assert(ids[k] == (int) k);
+    if (flags[k] == 'y')
+      total += prices[k];
+  }
+  // row by row scan
+  double expected = 0.0;
+  for (int k = 0; k < n; k++) {
+    item_t item;
+    soa_get_row(&items, k, &item);
+    assert(item.id == k && item.price == k * 0.5 && item.weight == k % 10);
+    if (item.flag == 'y')
+      expected += item.price;
+  }
+  assert(total == expected);
+  fprintf(stdout, "%d items, total price of the flagged ones: %.1f\n", n, total);
+
+  item_t item = make_item(-1);
+  soa_set_row(&items, 7, &item);
+  assert(*(int *) soa_nth(&items, 0, 7) == -1 && *(float *) soa_nth(&items, 3, 7) == -1.0f);
+  soa_dispose(&items);
+  fprintf(stdout, "[column test done]\n");
+}
+
+int main(int ignored, char **also_ignored) {
+  column_test();
+  return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Built with -DTRACE_LEVEL=4 (see makefile-trace): every TRACE_* macro is
+ * compiled in, until trace.h is included again below at a lower level.
+ */
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#if TRACE_LEVEL != TRACE_LVL_DEBUG
+#error "test_trace.c must be compiled with -DTRACE_LEVEL=4"
+#endif
+
+// reads the messages back from fp, at most max lines of TRACE_MSG_MAX bytes
+static int read_lines(FILE *fp, char lines[][TRACE_MSG_MAX + 1], int max) {
+  int n = 0;
+  rewind(fp);
+  while (n < max && fgets(lines[n], TRACE_MSG_MAX + 1, fp) != NULL) {
+    lines[n][strcspn(lines[n], "\n")] = '\0';
+    n++;
+  }
+  return n;
+}
+
+/**
+ * Function: ring_test
+ * -------------------
+ * Records more than TRACE_RING_SIZE messages in the ring buffer (printing
+ * none of them): trace_dump must give back the TRACE_RING_SIZE newest ones,
+ * oldest first, each with its level and call site.
+ */
+
+static char lines[TRACE_RING_SIZE + 1][TRACE_MSG_MAX + 1];
+
+static void ring_test() {
+  const int n = TRACE_RING_SIZE + 100;
+  fprintf(stdout, " ------------------------- Starting the ring test...\n");
+  trace_output(NULL);
+  trace_ring_enable(1);
+  for (int k = 0; k < n; k++)
+    TRACE_DEBUG("record %d", k);
+  FILE *fp = tmpfile();
+  assert(fp != NULL);
+  int dumped = trace_dump(fp);
+  assert(dumped == TRACE_RING_SIZE);
+  int num_lines = read_lines(fp, lines, TRACE_RING_SIZE + 1);
+  assert(num_lines == dumped);
+  for (int k = 0; k < TRACE_RING_SIZE; k++) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), " ring_test: record %d", n - TRACE_RING_SIZE + k);
+    assert(strncmp(lines[k], "[debug] ", 8) == 0 && strstr(lines[k], "test_trace.c:") != NULL);
+    assert(strcmp(lines[k] + strlen(lines[k]) - strlen(expected), expected) == 0);
+  }
+  fclose(fp);
+  // restarting the recording discards the old messages
+  trace_ring_enable(1);
+  fp = tmpfile();
+  dumped = trace_dump(fp);
+  assert(dumped == 0);
+  fclose(fp);
+  fprintf(stdout, "%d records, the last %d dumped in order\n", n, TRACE_RING_SIZE);
+  fprintf(stdout, "[ring test done]\n");
+}
+
+/**
+ * Function: output_test
+ * ---------------------
+ * trace_output sends the messages to the given stream, independently of the
+ * ring buffer; messages longer than TRACE_MSG_MAX are truncated.
+ */
+
+static void output_test() {
+  char big[2 * TRACE_MSG_MAX];
+  fprintf(stdout, "\n ------------------------- Starting the output test...\n");
+  FILE *fp = tmpfile();
+  assert(fp != NULL);
+  trace_ring_enable(0);
+  trace_output(fp);
+  TRACE_ERROR("disk %s", "full");
+  TRACE_WARN("%zu bytes left", (size_t) 42);
+  memset(big, 'x', sizeof(big) - 1);
+  big[sizeof(big) - 1] = '\0';
+  TRACE_INFO("%s", big);
+  trace_output(NULL);
+  TRACE_INFO("not printed");
+  int num_lines = read_lines(fp, lines, 4);
+  assert(num_lines == 3);
+  assert(strncmp(lines[0], "[error] ", 8) == 0 && strstr(lines[0], "disk full") != NULL);
+  assert(strncmp(lines[1], "[warn] ", 7) == 0 && strstr(lines[1], "42 bytes left") != NULL);
+  assert(strncmp(lines[2], "[info] ", 7) == 0 && strlen(lines[2]) == TRACE_MSG_MAX - 1);
+  fclose(fp);
+  fprintf(stdout, "[output test done]\n");
+}
+
+/*
+ * trace.h again, at TRACE_LVL_WARN: TRACE_INFO and TRACE_DEBUG must now
+ * expand to nothing, without evaluating their arguments.
+ */
+#undef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LVL_WARN
+#undef _trace_
+#undef TRACE_ERROR
+#undef TRACE_WARN
+#undef TRACE_INFO
+#undef TRACE_DEBUG
+#include "trace.h"
+
+/**
+ * Function: level_test
+ * --------------------
+ * With TRACE_LEVEL at TRACE_LVL_WARN, the TRACE_INFO and TRACE_DEBUG calls
+ * are compiled out (their arguments are not evaluated and nothing reaches
+ * the ring), while TRACE_ERROR and TRACE_WARN are kept.
+ */
+
+static void level_test() {
+  int evaluated = 0;
+  fprintf(stdout, "\n ------------------------- Starting the level test...\n");
+  trace_ring_enable(1);
+  TRACE_DEBUG("%d", ++evaluated);
+  TRACE_INFO("%d", ++evaluated);
+  assert(evaluated == 0);
+  TRACE_WARN("%d", ++evaluated);
+  TRACE_ERROR("%d", ++evaluated);
+  assert(evaluated == 2);
+  FILE *fp = tmpfile();
+  assert(fp != NULL);
+  int dumped = trace_dump(fp);
+  assert(dumped == 2);
+  int num_lines = read_lines(fp, lines, 3);
+  assert(num_lines == dumped);
+  assert(strncmp(lines[0], "[warn] ", 7) == 0 && strncmp(lines[1], "[error] ", 8) == 0);
+  fclose(fp);
+  trace_ring_enable(0);
+  fprintf(stdout, "[level test done]\n");
+}
+
+int main(int ignored, char **also_ignored) {
+  ring_test();
+  output_test();
+  level_test();
+  return 0;
+}
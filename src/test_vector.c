@@ -1,4 +1,6 @@
 #include "vector.h"
+#include "vector_tmpl.h"
+#include "counting_allocator.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -361,6 +363,746 @@ static void challenging_test() {
   vector_dispose(&lots_of_numbers);
 }
 
+/**
+ * Function: capacity_test
+ * -----------------------
+ * Checks the growth policy of the vector_t: the capacity grows
+ * geometrically while appending (so only a handful of reallocations
+ * happen for a large vector), vector_reserve sizes the buffer once
+ * and vector_shrink_to_fit gives the slack back.
+ */
+
+static void capacity_test() {
+  vector_t numbers;
+  size_t last_capacity = 0;
+  uint_t num_growths = 0;
+  fprintf(stdout, "\n\n------------------------- Starting the capacity tests...\n");
+  vector_new(&numbers, sizeof(long), NULL, 4);
+  assert(vector_capacity(&numbers) == VECTOR_INLINE_BYTES / sizeof(long));   // small buffer
+  for (long k = 0; k < 100000; k++) {
+    vector_append(&numbers, &k);
+    if (vector_capacity(&numbers) != last_capacity) {
+      last_capacity = vector_capacity(&numbers);
+      num_growths++;
+    }
+  }
+  assert(vector_len(&numbers) == 100000);
+  assert(vector_capacity(&numbers) >= vector_len(&numbers));
+  assert(num_growths < 20);
+  fprintf(stdout, "Appended 100000 longs with %u reallocation(s), capacity is %zu.\n",
+          num_growths, vector_capacity(&numbers));
+
+  vector_shrink_to_fit(&numbers);
+  assert(vector_capacity(&numbers) == vector_len(&numbers));
+  assert(*(long *) vector_nth(&numbers, 99999) == 99999);
+  vector_dispose(&numbers);
+
+  vector_new(&numbers, sizeof(long), NULL, 0);   // 0 means default chunk size
+  vector_reserve(&numbers, 5000);
+  assert(vector_capacity(&numbers) == 5000);
+  for (long k = 0; k < 5000; k++)
+    vector_append(&numbers, &k);
+  assert(vector_capacity(&numbers) == 5000);   // no reallocation happened
+  vector_reserve(&numbers, 10);                // never shrinks
+  assert(vector_capacity(&numbers) == 5000);
+  while (vector_len(&numbers) > 1) vector_delete(&numbers, vector_len(&numbers) - 1);
+  vector_shrink_to_fit(&numbers);   // back into the small buffer
+  assert(vector_capacity(&numbers) == VECTOR_INLINE_BYTES / sizeof(long));
+  assert(numbers.headptr == NULL && *(long *) vector_nth(&numbers, 0) == 0);
+  vector_dispose(&numbers);
+
+  // elements larger than 64KB (their size used to be stored in 16 bits)
+  vector_t blobs;
+  size_t blob_size = 100000;
+  char *blob = malloc(blob_size);
+  assert(blob != NULL);
+  vector_new(&blobs, blob_size, NULL, 0);
+  for (int k = 0; k < 3; k++) {
+    memset(blob, 'a' + k, blob_size);
+    vector_append(&blobs, blob);
+  }
+  for (size_t pos = 0; pos < vector_len(&blobs); pos++) {
+    char *p = vector_nth(&blobs, pos);
+    assert(p[0] == 'a' + (int) pos && p[blob_size - 1] == 'a' + (int) pos);
+  }
+  assert(vector_find_bytes(&blobs, blob, 0) == 2);
+  vector_dispose(&blobs);
+  free(blob);
+  fprintf(stdout, "[capacity tests done]\n");
+}
+
+/**
+ * Function: range_test
+ * --------------------
+ * Exercises the block operations: vector_append_n, vector_insert_range
+ * (at the front, in the middle and at the very end) and
+ * vector_erase_range, checking the contents after each step.
+ */
+
+static void check_range(vector_t *v, const char *expected) {
+  assert(vector_len(v) == strlen(expected));
+  for (uint_t pos = 0; pos < vector_len(v); pos++)
+    assert(*(char *) vector_nth(v, pos) == expected[pos]);
+}
+
+static void range_test() {
+  vector_t letters;
+  fprintf(stdout, "\n\n------------------------- Starting the range tests...\n");
+  vector_new(&letters, sizeof(char), NULL, 2);
+  vector_append_n(&letters, "abcdef", 6);
+  check_range(&letters, "abcdef");
+  vector_insert_range(&letters, "XYZ", 3, 0);
+  check_range(&letters, "XYZabcdef");
+  vector_insert_range(&letters, "--", 2, 5);
+  check_range(&letters, "XYZab--cdef");
+  vector_insert_range(&letters, "!", 1, vector_len(&letters));
+  check_range(&letters, "XYZab--cdef!");
+  vector_insert_range(&letters, "ignored", 0, 3);
+  check_range(&letters, "XYZab--cdef!");
+  vector_erase_range(&letters, 5, 2);
+  check_range(&letters, "XYZabcdef!");
+  vector_erase_range(&letters, 0, 3);
+  check_range(&letters, "abcdef!");
+  vector_erase_range(&letters, 6, 1);
+  check_range(&letters, "abcdef");
+  vector_erase_range(&letters, 0, vector_len(&letters));
+  check_range(&letters, "");
+  vector_dispose(&letters);
+  fprintf(stdout, "[range tests done]\n");
+}
+
+/**
+ * Function: compaction_test
+ * -------------------------
+ * Filters a large vector of longs with vector_remove_if (removing the
+ * multiples of 3), then de-duplicates a sorted vector with
+ * vector_dedup_sorted.  The free function counts how many elements
+ * were handed back to it, so we can check it is called exactly once
+ * per removed element.
+ */
+
+static uint_t num_freed = 0;
+
+static void count_free(void *elem_addr) {
+  num_freed++;
+}
+
+static bool is_multiple_of(const void *elem_addr, void *aux_data) {
+  return (*(const long *) elem_addr % *(long *) aux_data) == 0;
+}
+
+static void compaction_test() {
+  vector_t numbers;
+  long divisor = 3;
+  fprintf(stdout, "\n\n------------------------- Starting the compaction tests...\n");
+  vector_new(&numbers, sizeof(long), count_free, 0);
+  for (long k = 0; k < 300000; k++)
+    vector_append(&numbers, &k);
+  uint_t removed = vector_remove_if(&numbers, is_multiple_of, &divisor);
+  assert(removed == 100000 && num_freed == 100000);
+  assert(vector_len(&numbers) == 200000);
+  for (uint_t pos = 0; pos < vector_len(&numbers); pos++) {
+    long n = *(long *) vector_nth(&numbers, pos);
+    assert(n % 3 != 0 && n == (long) (pos / 2) * 3 + 1 + (long) (pos % 2));
+  }
+  fprintf(stdout, "Removed %u multiples of %ld in a single pass.\n", removed, divisor);
+
+  num_freed = 0;
+  vector_erase_range(&numbers, 0, vector_len(&numbers));
+  assert(num_freed == 200000);
+  num_freed = 0;
+  for (long k = 0; k < 1000; k++) {
+    long n = k / 4;          // 0 0 0 0 1 1 1 1 ...
+    vector_append(&numbers, &n);
+  }
+  removed = vector_dedup_sorted(&numbers, long_cmp);
+  assert(removed == 750 && num_freed == 750);
+  assert(vector_len(&numbers) == 250);
+  for (uint_t pos = 0; pos < vector_len(&numbers); pos++)
+    assert(*(long *) vector_nth(&numbers, pos) == pos);
+  assert(vector_dedup_sorted(&numbers, long_cmp) == 0);
+  fprintf(stdout, "Removed %u duplicates from the sorted vector.\n", removed);
+
+  num_freed = 0;
+  vector_dispose(&numbers);
+  assert(num_freed == 250);   // every remaining element is freed
+  fprintf(stdout, "[compaction tests done]\n");
+}
+
+/**
+ * Function: typed_test
+ * --------------------
+ * Instantiates type-specialized vectors with VECTOR_DEFINE (long) and
+ * VECTOR_DEFINE_CMP (a reverse ordering on doubles) and checks that
+ * push, at and sort behave as their generic counterparts: the longs
+ * are sorted and compared with the qsort result of a vector_t.
+ */
+
+VECTOR_DEFINE(longvec, long)
+
+#define DOUBLE_GREATER(a, b) ((a) > (b))
+VECTOR_DEFINE_CMP(dblvec, double, DOUBLE_GREATER)
+
+/*
+ * McIlroy's adversary for quicksorts: the values of the elements are only
+ * decided ("frozen") as the sort compares them, so as to pick every pivot
+ * among the smallest elements.  A plain quicksort does O(n^2) comparisons.
+ */
+static int  *adv_value;
+static int  adv_gas, adv_num_solid, adv_candidate;
+static long adv_compares;
+
+static int adversary_cmp(int x, int y) {
+  adv_compares++;
+  if (adv_value[x] == adv_gas && adv_value[y] == adv_gas)
+    adv_value[(x == adv_candidate) ? x : y] = adv_num_solid++;
+  if (adv_value[x] == adv_gas)
+    adv_candidate = x;
+  else if (adv_value[y] == adv_gas)
+    adv_candidate = y;
+  return adv_value[x] - adv_value[y];
+}
+
+#define ADVERSARY_LESS(a, b) (adversary_cmp((a), (b)) < 0)
+VECTOR_DEFINE_CMP(advvec, int, ADVERSARY_LESS)
+
+static void typed_test() {
+  longvec_t typed;
+  vector_t generic;
+  fprintf(stdout, "\n\n------------------------- Starting the typed vector tests...\n");
+  longvec_new(&typed, 0);
+  vector_new(&generic, sizeof(long), NULL, 0);
+  srand(107);
+  for (long k = 0; k < 200000; k++) {
+    long n = rand() % 1000;   // lots of duplicates
+    longvec_push(&typed, n);
+    vector_append(&generic, &n);
+  }
+  longvec_sort(&typed);
+  vector_sort(&generic, long_cmp);
+  assert(longvec_len(&typed) == vector_len(&generic));
+  for (size_t pos = 0; pos < longvec_len(&typed); pos++)
+    assert(*longvec_at(&typed, pos) == *(long *) vector_nth(&generic, pos));
+  longvec_dispose(&typed);
+  vector_dispose(&generic);
+
+  dblvec_t reals;
+  dblvec_new(&reals, 4);
+  for (int k = 0; k < 1000; k++)
+    dblvec_push(&reals, (k * 7919) % 1000 / 10.0);
+  dblvec_sort(&reals);
+  for (size_t pos = 1; pos < dblvec_len(&reals); pos++)
+    assert(*dblvec_at(&reals, pos - 1) >= *dblvec_at(&reals, pos));
+  dblvec_dispose(&reals);
+
+  // the adversary cannot push name_sort past O(n log n)
+  const int n = 20000;
+  advvec_t indexes;
+  advvec_new(&indexes, n);
+  adv_value = malloc(n * sizeof(int));
+  assert(adv_value != NULL);
+  adv_gas = n;
+  adv_num_solid = adv_candidate = 0;
+  adv_compares = 0;
+  for (int k = 0; k < n; k++) {
+    adv_value[k] = adv_gas;
+    advvec_push(&indexes, k);
+  }
+  advvec_sort(&indexes);
+  for (size_t pos = 1; pos < advvec_len(&indexes); pos++)
+    assert(adv_value[*advvec_at(&indexes, pos - 1)] <= adv_value[*advvec_at(&indexes, pos)]);
+  fprintf(stdout, "%ld comparisons to sort %d adversarial elements\n", adv_compares, n);
+  assert(adv_compares < 10L * n * 15);   // 10 n log2(n), where a plain quicksort needs ~ n^2 / 4
+  free(adv_value);
+  advvec_dispose(&indexes);
+  fprintf(stdout, "[typed vector tests done]\n");
+}
+
+/**
+ * Function: sorted_test
+ * ---------------------
+ * Builds a sorted vector with vector_insert_sorted only (no call to
+ * vector_sort) from a permutation with duplicates, then checks the
+ * ordering, the bounds returned by vector_lower_bound,
+ * vector_upper_bound and vector_equal_range, and that the sorted
+ * vector_search honors its startIndex.
+ */
+
+static void sorted_test() {
+  vector_t numbers;
+  size_t first, last;
+  fprintf(stdout, "\n\n------------------------- Starting the sorted vector tests...\n");
+  vector_new(&numbers, sizeof(long), NULL, 0);
+  for (long k = 0; k < 3000; k++) {
+    long n = (k * 1399) % 1000;   // each of 0..999 three times
+    uint_t pos = vector_insert_sorted(&numbers, &n, long_cmp);
+    assert(*(long *) vector_nth(&numbers, pos) == n);
+  }
+  for (uint_t pos = 0; pos < vector_len(&numbers); pos++)
+    assert(*(long *) vector_nth(&numbers, pos) == pos / 3);
+
+  long key = 500;
+  assert(vector_lower_bound(&numbers, &key, long_cmp) == 1500);
+  assert(vector_upper_bound(&numbers, &key, long_cmp) == 1503);
+  vector_equal_range(&numbers, &key, long_cmp, &first, &last);
+  assert(first == 1500 && last == 1503);
+  assert(vector_search(&numbers, &key, long_cmp, 0, true) == 1500);
+  assert(vector_search(&numbers, &key, long_cmp, 1502, true) == 1502);
+  assert(vector_search(&numbers, &key, long_cmp, 1503, true) == -1);
+
+  key = -1;
+  vector_equal_range(&numbers, &key, long_cmp, &first, &last);
+  assert(first == 0 && last == 0);
+  key = 1000;
+  assert(vector_lower_bound(&numbers, &key, long_cmp) == vector_len(&numbers));
+  assert(vector_search(&numbers, &key, long_cmp, 0, true) == -1);
+  vector_dispose(&numbers);
+  fprintf(stdout, "[sorted vector tests done]\n");
+}
+
+/**
+ * Function: parallel_sort_test
+ * ----------------------------
+ * Sorts the same large permutation as challenging_test, but with
+ * vector_sort_parallel, using an odd number of threads (so that an
+ * odd run is left over when merging) and the default number of threads.
+ */
+
+static void parallel_sort_test() {
+  uint_t nthreads[] = { 3, 0 };
+  fprintf(stdout, "\n\n------------------------- Starting the parallel sort tests...\n");
+  for (int k = 0; k < sizeof(nthreads) / sizeof(nthreads[0]); k++) {
+    vector_t numbers;
+    vector_new(&numbers, sizeof(long), NULL, 0);
+    insert_permutation_of_num(&numbers, klarge_prime, keven_larger_prime);
+    vector_sort_parallel(&numbers, long_cmp, nthreads[k]);
+    for (long residue = 0; residue < vector_len(&numbers); residue++)
+      assert(*(const long *) vector_nth(&numbers, residue) == residue);
+    fprintf(stdout, "Sorted with %u thread(s) (0 means one per CPU).\n", nthreads[k]);
+    vector_dispose(&numbers);
+  }
+  fprintf(stdout, "[parallel sort tests done]\n");
+}
+
+/**
+ * Function: radix_sort_test
+ * -------------------------
+ * Sorts the large permutation with vector_radix_sort (the numbers fit
+ * in 22 bits), then checks the sort is stable: records sharing the
+ * same key must keep their original relative order.
+ */
+
+struct record {
+  int key;
+  int seq;
+};
+
+static uint64_t long_key(const void *elem_addr) {
+  return (uint64_t) *(const long *) elem_addr;
+}
+
+static uint64_t record_key(const void *elem_addr) {
+  // flip the sign bit, so that negative keys come first
+  return (uint32_t) ((const struct record *) elem_addr)->key ^ 0x80000000u;
+}
+
+static void radix_sort_test() {
+  vector_t numbers, records;
+  fprintf(stdout, "\n\n------------------------- Starting the radix sort tests...\n");
+  vector_new(&numbers, sizeof(long), NULL, 0);
+  insert_permutation_of_num(&numbers, klarge_prime, keven_larger_prime);
+  vector_radix_sort(&numbers, long_key, 22);
+  for (long residue = 0; residue < vector_len(&numbers); residue++)
+    assert(*(const long *) vector_nth(&numbers, residue) == residue);
+  vector_dispose(&numbers);
+
+  vector_new(&records, sizeof(struct record), NULL, 0);
+  for (int k = 0; k < 100000; k++) {
+    struct record r = { (k * 7919) % 2001 - 1000, k };
+    vector_append(&records, &r);
+  }
+  vector_radix_sort(&records, record_key, 32);
+  for (uint_t pos = 1; pos < vector_len(&records); pos++) {
+    const struct record *prev = vector_nth(&records, pos - 1);
+    const struct record *curr = vector_nth(&records, pos);
+    assert(prev->key < curr->key || (prev->key == curr->key && prev->seq < curr->seq));
+  }
+  assert(((const struct record *) vector_nth(&records, 0))->key == -1000);
+  vector_dispose(&records);
+  fprintf(stdout, "[radix sort tests done]\n");
+}
+
+/**
+ * Function: sort_by_key_test
+ * --------------------------
+ * Sorts strings by length with vector_sort_by_key (the key is computed
+ * once per element, following the pointer) and checks that strings of the
+ * same length keep their original order; then sorts records on a 16-byte
+ * composite key (descending double, then ascending int).
+ */
+
+static void strlen_key(const void *elem_addr, void *key_addr) {
+  size_t len = strlen(*(char * const *) elem_addr);
+  memcpy(key_addr, &len, sizeof(len));
+}
+
+static int size_t_cmp(const void *vp1, const void *vp2) {
+  size_t a = *(const size_t *) vp1, b = *(const size_t *) vp2;
+  return (a > b) - (a < b);
+}
+
+struct composite_key {
+  double weight;
+  int    id;
+};
+
+static void composite_key(const void *elem_addr, void *key_addr) {
+  const struct record *r = elem_addr;
+  struct composite_key key = { .weight = r->key % 7, .id = r->seq % 5 };
+  memcpy(key_addr, &key, sizeof(key));
+}
+
+static int composite_cmp(const void *vp1, const void *vp2) {
+  const struct composite_key *a = vp1, *b = vp2;
+  if (a->weight != b->weight)
+    return (a->weight < b->weight) - (a->weight > b->weight);   // descending
+  return (a->id > b->id) - (a->id < b->id);
+}
+
+static void sort_by_key_test() {
+  const char *words[] = { "pear", "fig", "banana", "kiwi", "plum", "apple", "lime", "date", "cherry", "yam" };
+  const char *expected[] = { "fig", "yam", "pear", "kiwi", "plum", "lime", "date", "apple", "banana", "cherry" };
+  const size_t nwords = sizeof(words) / sizeof(words[0]);
+  vector_t strings, records;
+  fprintf(stdout, "\n\n------------------------- Starting the sort by key tests...\n");
+  vector_new(&strings, sizeof(char *), NULL, 0);
+  for (size_t k = 0; k < nwords; k++)
+    vector_append(&strings, &words[k]);
+  vector_sort_by_key(&strings, strlen_key, sizeof(size_t), size_t_cmp);
+  for (size_t k = 0; k < nwords; k++)
+    assert(strcmp(*(char **) vector_nth(&strings, k), expected[k]) == 0);
+  vector_dispose(&strings);
+
+  vector_new(&records, sizeof(struct record), NULL, 0);
+  for (int k = 0; k < 100000; k++) {
+    struct record r = { (k * 7919) % 2001, k };
+    vector_append(&records, &r);
+  }
+  vector_sort_by_key(&records, composite_key, sizeof(struct composite_key), composite_cmp);
+  for (size_t pos = 1; pos < vector_len(&records); pos++) {
+    const struct record *prev = vector_nth(&records, pos - 1);
+    const struct record *curr = vector_nth(&records, pos);
+    struct composite_key kp, kc;
+    composite_key(prev, &kp);
+    composite_key(curr, &kc);
+    int res = composite_cmp(&kp, &kc);
+    assert(res < 0 || (res == 0 && prev->seq < curr->seq));
+  }
+  vector_dispose(&records);
+  fprintf(stdout, "[sort by key tests done]\n");
+}
+
+/**
+ * Function: selection_test
+ * ------------------------
+ * Checks vector_nth_element, vector_partial_sort and vector_topk against a
+ * fully sorted copy, on a permutation with many duplicates and on an already
+ * sorted vector (a bad case for a naive quickselect).
+ */
+
+static void copy_longs(vector_t *copy, const vector_t *numbers) {
+  vector_new(copy, sizeof(long), NULL, vector_len(numbers));
+  vector_append_n(copy, vector_data(numbers), vector_len(numbers));
+}
+
+static void check_selection(const vector_t *numbers, const vector_t *sorted) {
+  size_t n = vector_len(sorted);
+  vector_t copy, top;
+  for (size_t nth = 0; nth < n; nth += n / 7 + 1) {
+    copy_longs(&copy, numbers);
+    vector_nth_element(&copy, nth, long_cmp);
+    long pivot = *(long *) vector_nth(&copy, nth);
+    assert(pivot == *(long *) vector_nth(sorted, nth));
+    for (size_t pos = 0; pos < n; pos++)
+      assert((pos < nth) ? *(long *) vector_nth(&copy, pos) <= pivot : *(long *) vector_nth(&copy, pos) >= pivot);
+    vector_dispose(&copy);
+  }
+  size_t k = n / 10;
+  copy_longs(&copy, numbers);
+  vector_partial_sort(&copy, k, long_cmp);
+  for (size_t pos = 0; pos < k; pos++)
+    assert(*(long *) vector_nth(&copy, pos) == *(long *) vector_nth(sorted, pos));
+  vector_dispose(&copy);
+
+  vector_new(&top, sizeof(long), NULL, 0);
+  vector_topk(numbers, k, long_cmp, &top);
+  assert(vector_len(&top) == k);
+  for (size_t pos = 0; pos < k; pos++)
+    assert(*(long *) vector_nth(&top, pos) == *(long *) vector_nth(sorted, n - 1 - pos));
+  vector_topk(numbers, n + 5, long_cmp, &top);
+  assert(vector_len(&top) == k + n);
+  vector_dispose(&top);
+}
+
+static void selection_test() {
+  vector_t numbers, sorted;
+  fprintf(stdout, "\n\n------------------------- Starting the selection tests...\n");
+  vector_new(&numbers, sizeof(long), NULL, 0);
+  for (long k = 0; k < 20000; k++) {
+    long value = (k * 7919) % 20011 % 1000;
+    vector_append(&numbers, &value);
+  }
+  copy_longs(&sorted, &numbers);
+  vector_sort(&sorted, long_cmp);
+  check_selection(&numbers, &sorted);
+  check_selection(&sorted, &sorted);
+  vector_dispose(&sorted);
+  vector_dispose(&numbers);
+  fprintf(stdout, "[selection tests done]\n");
+}
+
+/**
+ * Function: parallel_map_test
+ * ---------------------------
+ * Squares every element with vector_map_parallel, then sums them up
+ * with vector_reduce and vector_reduce_parallel (with several thread
+ * counts, including more threads than elements) and checks all the
+ * sums agree with the closed formula.
+ */
+
+static void square_long(void *elem_addr, void *aux_data) {
+  long *n = elem_addr;
+  *n = *n * *n;
+}
+
+static void add_long(void *acc_addr, const void *elem_addr, void *aux_data) {
+  *(long long *) acc_addr += *(const long *) elem_addr;
+}
+
+static void combine_sum(void *acc_addr, const void *other_acc_addr, void *aux_data) {
+  *(long long *) acc_addr += *(const long long *) other_acc_addr;
+}
+
+static void parallel_map_test() {
+  vector_t numbers;
+  const long n = 100000;
+  const long long expected = (long long) (n - 1) * n * (2 * n - 1) / 6;   // sum of k^2
+  uint_t nthreads[] = { 1, 4, 0 };
+  fprintf(stdout, "\n\n------------------------- Starting the parallel map/reduce tests...\n");
+  vector_new(&numbers, sizeof(long), NULL, 0);
+  for (long k = 0; k < n; k++)
+    vector_append(&numbers, &k);
+  vector_map_parallel(&numbers, square_long, NULL, 3);
+  long long sum = 0;
+  vector_reduce(&numbers, &sum, add_long, NULL);
+  assert(sum == expected);
+  for (int k = 0; k < sizeof(nthreads) / sizeof(nthreads[0]); k++) {
+    sum = 0;
+    vector_reduce_parallel(&numbers, &sum, sizeof(sum), add_long, combine_sum, NULL, nthreads[k]);
+    assert(sum == expected);
+  }
+  vector_erase_range(&numbers, 2, vector_len(&numbers) - 2);   // 0 1
+  sum = 0;
+  vector_reduce_parallel(&numbers, &sum, sizeof(sum), add_long, combine_sum, NULL, 8);
+  assert(sum == 1);
+  vector_map_parallel(&numbers, square_long, NULL, 8);
+  vector_dispose(&numbers);
+  fprintf(stdout, "[parallel map/reduce tests done]\n");
+}
+
+/**
+ * Function: foreach_test
+ * ----------------------
+ * Checks that VECTOR_FOREACH visits every element in order, both in the
+ * small buffer and on the heap, can update them in place, and does not
+ * run its body on an empty vector.
+ */
+
+static void foreach_test() {
+  vector_t numbers;
+  long expected = 0;
+  fprintf(stdout, "\n\n------------------------- Starting the foreach tests...\n");
+  vector_new(&numbers, sizeof(long), NULL, 0);
+  VECTOR_FOREACH(&numbers, long, p)
+    assert(0);   // empty
+  for (long k = 0; k < 1000; k++) {
+    vector_append(&numbers, &k);
+    long sum = 0, next = 0;
+    VECTOR_FOREACH(&numbers, long, p) {
+      assert(*p == next++);
+      sum += *p;
+    }
+    assert(next == k + 1 && sum == k * (k + 1) / 2);
+  }
+  VECTOR_FOREACH(&numbers, long, p)
+    *p *= 2;
+  VECTOR_FOREACH(&numbers, long, p)
+    expected += *p;
+  assert(expected == 999 * 1000);
+  vector_dispose(&numbers);
+  fprintf(stdout, "[foreach tests done]\n");
+}
+
+/**
+ * Function: find_bytes_test
+ * -------------------------
+ * For each element size (those with a SIMD fast path, and 3 and 12
+ * bytes which take the scalar path), fills a vector with elements made
+ * of few distinct byte values (so that partial matches are frequent),
+ * then checks vector_find_bytes against a plain memcmp scan for many
+ * keys and start indices.
+ */
+
+static int find_bytes_slow(vector_t *v, const void *key, uint_t start) {
+  for (uint_t pos = start; pos < vector_len(v); pos++)
+    if (memcmp(vector_nth(v, pos), key, v->elem_size) == 0)
+      return pos;
+  return -1;
+}
+
+static void find_bytes_test() {
+  const usint_t elem_sizes[] = { 1, 2, 3, 4, 8, 12, 16 };
+  unsigned char elem[16];
+  fprintf(stdout, "\n\n------------------------- Starting the find bytes tests...\n");
+  srand(107);
+  for (int k = 0; k < sizeof(elem_sizes) / sizeof(elem_sizes[0]); k++) {
+    vector_t v;
+    vector_new(&v, elem_sizes[k], NULL, 0);
+    for (int n = 0; n < 1000; n++) {
+      for (int b = 0; b < elem_sizes[k]; b++)
+        elem[b] = (elem_sizes[k] == 1) ? rand() % 251 : rand() % 2;
+      vector_append(&v, elem);
+    }
+    for (int trial = 0; trial < 2000; trial++) {
+      uint_t start = rand() % (vector_len(&v) + 1);
+      if (trial % 2 == 0 && start < vector_len(&v))   // a key which is there
+        memcpy(elem, vector_nth(&v, rand() % vector_len(&v)), elem_sizes[k]);
+      else
+        for (int b = 0; b < elem_sizes[k]; b++)
+          elem[b] = rand() % 3;
+      assert(vector_find_bytes(&v, elem, start) == find_bytes_slow(&v, elem, start));
+    }
+    vector_dispose(&v);
+  }
+  fprintf(stdout, "[find bytes tests done]\n");
+}
+
+/**
+ * Function: small_buffer_test
+ * ---------------------------
+ * A vector of a few ints stays in its small buffer (no heap storage),
+ * even when copied by value, then spills to the heap when it grows and
+ * goes back into the small buffer on vector_shrink_to_fit.
+ */
+
+static void small_buffer_test() {
+  vector_t small, copy;
+  const int kinline = VECTOR_INLINE_BYTES / sizeof(int);
+  fprintf(stdout, "\n\n------------------------- Starting the small buffer tests...\n");
+  vector_new(&small, sizeof(int), NULL, 4);
+  for (int k = 0; k < kinline; k++)
+    vector_append(&small, &k);
+  assert(small.headptr == NULL && vector_capacity(&small) == kinline);
+  copy = small;   // a struct copy is a valid vector_t
+  for (int k = 0; k < kinline; k++)
+    assert(*(int *) vector_nth(&copy, k) == k);
+  vector_append(&small, &kinline);   // spill to the heap
+  assert(small.headptr != NULL && vector_capacity(&small) > kinline);
+  for (int k = 0; k <= kinline; k++)
+    assert(*(int *) vector_nth(&small, k) == k);
+  vector_delete(&small, 0);
+  vector_shrink_to_fit(&small);
+  assert(small.headptr == NULL);
+  for (int k = 0; k < kinline; k++)
+    assert(*(int *) vector_nth(&small, k) == k + 1);
+  vector_dispose(&small);
+  fprintf(stdout, "[small buffer tests done]\n");
+}
+
+/**
+ * Function: allocator_test
+ * ------------------------
+ * A vector created with vector_new_with takes all its heap storage from
+ * the given allocator: a counting allocator checks that every block it
+ * handed out (including across reallocations and shrinking back into the
+ * small buffer) is given back, with the right size, by vector_dispose.
+ */
+
+static void allocator_test() {
+  struct counting_allocator counts;
+  const allocator_t alloc = counting_allocator(&counts);
+  vector_t numbers;
+  fprintf(stdout, "\n\n------------------------- Starting the allocator tests...\n");
+  vector_new_with(&numbers, sizeof(long), NULL, 0, &alloc);
+  for (long k = 0; k < 10000; k++)
+    vector_append(&numbers, &k);
+  assert(counts.live_bytes == vector_capacity(&numbers) * sizeof(long));
+  vector_erase_range(&numbers, 1, vector_len(&numbers) - 1);
+  vector_shrink_to_fit(&numbers);   // back into the small buffer
+  assert(counts.live_bytes == 0);
+  for (long k = 0; k < 100; k++)
+    vector_append(&numbers, &k);
+  vector_sort(&numbers, long_cmp);
+  vector_dispose(&numbers);
+  unsigned int num_calls = counts.num_allocs + counts.num_reallocs + counts.num_frees;
+  assert(counts.live_bytes == 0 && counts.num_allocs == counts.num_frees && num_calls > 2);
+  fprintf(stdout, "%u allocator calls, all the storage was given back.\n", num_calls);
+  fprintf(stdout, "[allocator tests done]\n");
+}
+
+/**
+ * Function: persistence_test
+ * --------------------------
+ * Saves a vector of structs, maps it back read-only (checks the
+ * contents, searches it, sorts the private copy and checks the file is
+ * unchanged), then maps it read-write, deletes elements in place and
+ * checks the file reflects it, and finally grows the mapped vector,
+ * which moves it to the heap.
+ */
+
+static void persistence_test() {
+  const char *path = "/tmp/test_vector.vec";
+  vector_t records, mapped;
+  fprintf(stdout, "\n\n------------------------- Starting the persistence tests...\n");
+  vector_new(&records, sizeof(struct record), NULL, 0);
+  for (int k = 0; k < 10000; k++) {
+    struct record r = { 9999 - k, k };
+    vector_append(&records, &r);
+  }
+  assert(vector_save(&records, path));
+
+  assert(vector_open_mmap(&mapped, path, true));
+  assert(vector_len(&mapped) == 10000 && mapped.elem_size == sizeof(struct record));
+  for (uint_t pos = 0; pos < vector_len(&mapped); pos++)
+    assert(memcmp(vector_nth(&mapped, pos), vector_nth(&records, pos), sizeof(struct record)) == 0);
+  struct record key = { 9990, 9 };
+  assert(vector_find_bytes(&mapped, &key, 0) == 9);
+  vector_radix_sort(&mapped, record_key, 32);   // private copy-on-write pages
+  assert(((struct record *) vector_nth(&mapped, 0))->key == 0);
+  vector_dispose(&mapped);
+
+  assert(vector_open_mmap(&mapped, path, false));
+  assert(((struct record *) vector_nth(&mapped, 0))->key == 9999);   // file untouched
+  vector_erase_range(&mapped, 0, 5000);
+  vector_dispose(&mapped);   // the new count is written back
+  assert(vector_open_mmap(&mapped, path, false));
+  assert(vector_len(&mapped) == 5000);
+  assert(((struct record *) vector_nth(&mapped, 0))->seq == 5000);
+  vector_append(&mapped, &key);   // moves to the heap, the file is left as is
+  assert(vector_len(&mapped) == 5001);
+  assert(((struct record *) vector_nth(&mapped, 4999))->seq == 9999);
+  vector_dispose(&mapped);
+  assert(vector_open_mmap(&mapped, path, true));
+  assert(vector_len(&mapped) == 5000);
+  vector_dispose(&mapped);
+
+  assert(!vector_open_mmap(&mapped, "/nonexistent/test_vector.vec", true));
+  assert(!vector_open_mmap(&mapped, "src/test_vector.c", true));   // not a vector file
+  remove(path);
+  vector_dispose(&records);
+  fprintf(stdout, "[persistence tests done]\n");
+}
+
 /** 
  * Function: free_string
  * --------------------
@@ -444,6 +1186,21 @@ static void memory_test()
 int main(int ignored, char **also_Ignored) {
   simple_test();
   challenging_test();
+  capacity_test();
+  range_test();
+  compaction_test();
+  typed_test();
+  sorted_test();
+  parallel_sort_test();
+  radix_sort_test();
+  sort_by_key_test();
+  selection_test();
+  parallel_map_test();
+  foreach_test();
+  find_bytes_test();
+  small_buffer_test();
+  allocator_test();
+  persistence_test();
   memory_test();
   return 0;
 }